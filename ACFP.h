@@ -1,16 +1,69 @@
 // Copyright (c) 2024 Matt M Halenza
 // SPDX-License-Identifier: MIT
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <cstring>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <version>
+#if __cpp_lib_expected >= 202202L
+#include <expected>
+#define ACFP_HAS_EXPECTED 1
+#else
+#define ACFP_HAS_EXPECTED 0
+#endif
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ACFP_HAS_MMAP 1
+#else
+#define ACFP_HAS_MMAP 0
+#endif
+#if __has_include(<sys/inotify.h>)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#define ACFP_HAS_INOTIFY 1
+#else
+#define ACFP_HAS_INOTIFY 0
+#endif
+#if !defined(ACFP_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ACFP_HAS_X86_SIMD 1
+#else
+#define ACFP_HAS_X86_SIMD 0
+#endif
 
 namespace ACFP {
 
@@ -26,35 +79,113 @@ public:
     ConfigValueConvertException(std::string const& msg) : std::runtime_error(msg) {}
     ConfigValueConvertException(char const* msg) : std::runtime_error(msg) {}
 };
+class ConfigInterpolationException : public std::runtime_error
+{
+public:
+    ConfigInterpolationException(std::string const& msg) : std::runtime_error(msg) {}
+    ConfigInterpolationException(char const* msg) : std::runtime_error(msg) {}
+};
+class ConfigImageException : public std::runtime_error
+{
+public:
+    ConfigImageException(std::string const& msg) : std::runtime_error(msg) {}
+    ConfigImageException(char const* msg) : std::runtime_error(msg) {}
+};
+
+// Why a value did not convert, without building a message: the non-throwing counterpart of
+// ConfigValueConvertException.
+struct ConvertError
+{
+    enum class Code : std::uint8_t
+    {
+        InvalidArgument,
+        OutOfRange,
+        // tryGetFieldAs: the key is not present.
+        MissingField,
+    };
+    Code code;
+    // Offset into the value where conversion failed.
+    std::uint32_t offset = 0;
+};
+
+// The conversions behind the built-in Parsers: store the value in out, or return why there is none.
+inline
+std::optional<ConvertError> convertValue(std::string_view sv, bool& out)
+{
+    if (sv.size() > 0) {
+        switch (sv[0]) {
+            case '0':
+            case 'f':
+            case 'n':
+            case 'F':
+            case 'N':
+                out = false;
+                return std::nullopt;
+            case '1':
+            case 't':
+            case 'y':
+            case 'T':
+            case 'Y':
+                out = true;
+                return std::nullopt;
+        }
+    }
+    return ConvertError{ ConvertError::Code::InvalidArgument };
+}
+template <typename T>
+    requires std::integral<T> || std::floating_point<T>
+inline
+std::optional<ConvertError> convertValue(std::string_view sv, T& out)
+{
+    auto const [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), out);
+    if (ec == std::errc{})
+        return std::nullopt;
+    auto const offset = static_cast<std::uint32_t>(ptr - sv.data());
+    if (ec == std::errc::result_out_of_range)
+        return ConvertError{ ConvertError::Code::OutOfRange, offset };
+    return ConvertError{ ConvertError::Code::InvalidArgument, offset };
+}
 
 template <typename T>
 struct Parser
 {
     /* static T parse(std::string_view); */
+    /* optional (C++23): static std::expected<T, ConvertError> tryParse(std::string_view); */
 };
 
 template <>
 struct Parser<bool>
 {
+#if ACFP_HAS_EXPECTED
+    static std::expected<bool, ConvertError> tryParse(std::string_view sv)
+    {
+        bool v{};
+        if (auto const error = convertValue(sv, v))
+            return std::unexpected(*error);
+        return v;
+    }
+#endif
     static bool parse(std::string_view sv)
     {
-        if (sv.size() > 0) {
-            switch (sv[0]) {
-                case '0':
-                case 'f':
-                case 'n':
-                case 'F':
-                case 'N':
-                    return false;
-                case '1':
-                case 't':
-                case 'y':
-                case 'T':
-                case 'Y':
-                    return true;
-            }
-        }
-        throw ConfigValueConvertException(std::format("Could not parse '{}' as bool", sv));
+        bool v{};
+        if (convertValue(sv, v))
+            throw ConfigValueConvertException(std::format("Could not parse '{}' as bool", sv));
+        return v;
+    }
+};
+
+template <>
+struct Parser<std::string>
+{
+#if ACFP_HAS_EXPECTED
+    static std::expected<std::string, ConvertError> tryParse(std::string_view sv)
+    {
+        return std::string{ sv };
+    }
+#endif
+    static std::string parse(std::string_view sv)
+    {
+        return std::string{ sv };
     }
 };
 
@@ -62,17 +193,24 @@ template <typename T>
     requires std::integral<T> || std::floating_point<T>
 struct Parser<T>
 {
+#if ACFP_HAS_EXPECTED
+    static std::expected<T, ConvertError> tryParse(std::string_view sv)
+    {
+        T v{};
+        if (auto const error = convertValue(sv, v))
+            return std::unexpected(*error);
+        return v;
+    }
+#endif
     static T parse(std::string_view sv)
     {
-        T v;
-        auto const [ptr, ec] = std::from_chars(sv.begin(), sv.end(), v);
-        if (ec == std::errc::result_out_of_range)
+        T v{};
+        auto const error = convertValue(sv, v);
+        if (!error)
+            return v;
+        if (error->code == ConvertError::Code::OutOfRange)
             throw ConfigValueConvertException(std::format("String '{}' not representible in type {}", sv, typeid(T).name()));
-        if (ec == std::errc::invalid_argument)
-            throw ConfigValueConvertException(std::format("String '{}' is not a valid {}", sv, typeid(T).name()));
-        if (ec != std::errc{})
-            throw ConfigValueConvertException(std::format("Unknown error while parsing '{}' as a {}", sv, typeid(T).name()));
-        return v;
+        throw ConfigValueConvertException(std::format("String '{}' is not a valid {}", sv, typeid(T).name()));
     }
 };
 
@@ -83,6 +221,31 @@ T parse(std::string_view sv)
     return Parser<T>::parse(sv);
 }
 
+#if ACFP_HAS_EXPECTED
+template <typename T>
+concept HasTryParse = requires(std::string_view sv) {
+    { Parser<T>::tryParse(sv) } -> std::same_as<std::expected<T, ConvertError>>;
+};
+// Parser<T>::tryParse where the Parser provides one; otherwise Parser<T>::parse with its exception
+// turned into an InvalidArgument error.
+template <typename T>
+inline
+std::expected<T, ConvertError> tryParse(std::string_view sv)
+{
+    if constexpr (HasTryParse<T>) {
+        return Parser<T>::tryParse(sv);
+    }
+    else {
+        try {
+            return Parser<T>::parse(sv);
+        }
+        catch (ConfigValueConvertException const&) {
+            return std::unexpected(ConvertError{ ConvertError::Code::InvalidArgument });
+        }
+    }
+}
+#endif
+
 template <typename T>
 inline
 std::optional<T> parse(std::optional<std::string_view> osv)
@@ -93,50 +256,483 @@ std::optional<T> parse(std::optional<std::string_view> osv)
     return std::nullopt;
 }
 
+// Transparent hash/equality so the maps below can be probed with a std::string_view without allocating a key.
+struct StringHash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view sv) const
+    {
+        return std::hash<std::string_view>{}(sv);
+    }
+};
+struct StringEqual
+{
+    using is_transparent = void;
+    bool operator()(std::string_view lhs, std::string_view rhs) const
+    {
+        return lhs == rhs;
+    }
+};
+
+// Either an owned copy of a string or a borrowed view into a buffer that outlives it
+// (for tables parsed with ParseOptions::zero_copy, the ConfigTable keeps that buffer alive).
+// Owned copies are allocated from the memory resource of the enclosing table.
+class ConfigString final
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    ConfigString() = default;
+    explicit ConfigString(allocator_type alloc) : owned(alloc) {}
+    explicit ConfigString(std::string_view sv, allocator_type alloc = {}) : owned(sv, alloc) {}
+    ConfigString(ConfigString const& other) = default;
+    ConfigString(ConfigString&& other) = default;
+    ConfigString(ConfigString const& other, allocator_type alloc) : owned(other.owned, alloc), borrowed(other.borrowed), is_borrowed(other.is_borrowed) {}
+    ConfigString(ConfigString&& other, allocator_type alloc) : owned(std::move(other.owned), alloc), borrowed(other.borrowed), is_borrowed(other.is_borrowed) {}
+    ConfigString& operator=(ConfigString const& other) = default;
+    ConfigString& operator=(ConfigString&& other) = default;
+
+    static ConfigString borrow(std::string_view sv)
+    {
+        ConfigString cs;
+        cs.borrowed = sv;
+        cs.is_borrowed = true;
+        return cs;
+    }
+    void assign(std::string_view sv)
+    {
+        this->owned.assign(sv);
+        this->borrowed = {};
+        this->is_borrowed = false;
+    }
+    void assignBorrowed(std::string_view sv)
+    {
+        this->owned.clear();
+        this->borrowed = sv;
+        this->is_borrowed = true;
+    }
+    std::string_view view() const
+    {
+        return this->is_borrowed ? this->borrowed : std::string_view{ this->owned };
+    }
+    operator std::string_view() const
+    {
+        return this->view();
+    }
+    bool operator==(ConfigString const& other) const
+    {
+        return this->view() == other.view();
+    }
+private:
+    std::pmr::string owned;
+    std::string_view borrowed;
+    bool is_borrowed = false;
+};
+
+// Forward iterator over one of the maps below, yielding (name, value) pairs with the name as a
+// std::string_view and the value as Mapped (a std::string_view for fields, a const reference otherwise).
+template <typename MapIterator, typename Mapped>
+class EntryIterator final
+{
+public:
+    // Dereferencing yields a pair by value, so this is only a C++17 input iterator, but a C++20 forward one.
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::pair<std::string_view, Mapped>;
+    using reference = value_type;
+    using pointer = void;
+
+    EntryIterator() = default;
+    explicit EntryIterator(MapIterator it) : it(it) {}
+
+    value_type operator*() const
+    {
+        if constexpr (std::is_same_v<Mapped, std::string_view>)
+            return value_type{ std::string_view{ this->it->first }, this->it->second.view() };
+        else if constexpr (requires { *this->it->second; })
+            return value_type{ std::string_view{ this->it->first }, *this->it->second };
+        else
+            return value_type{ std::string_view{ this->it->first }, this->it->second };
+    }
+    EntryIterator& operator++()
+    {
+        ++this->it;
+        return *this;
+    }
+    EntryIterator operator++(int)
+    {
+        auto copy = *this;
+        ++this->it;
+        return copy;
+    }
+    bool operator==(EntryIterator const& other) const = default;
+private:
+    MapIterator it;
+};
+
+// Remembers the last typed parse of a field value, so repeated reads as that type are a load.
+// Only arithmetic types (which fit in 64 bits) are cached.  Readers may fill it concurrently: whoever
+// claims the slot publishes its result, replacing a cached value of another type; the others just parse.
+// Writes to the field clear it.
+class TypedValueCache final
+{
+public:
+    TypedValueCache() = default;
+    // A cache is never copied along with its value; the copy starts empty.
+    TypedValueCache(TypedValueCache const&) noexcept {}
+    TypedValueCache& operator=(TypedValueCache const&) noexcept
+    {
+        this->clear();
+        return *this;
+    }
+
+    template <typename T>
+    static constexpr bool cacheable = std::is_arithmetic_v<T> && sizeof(T) <= sizeof(std::uint64_t);
+
+    void clear()
+    {
+        this->state.store(empty, std::memory_order_relaxed);
+    }
+    template <typename T>
+    std::optional<T> load() const
+    {
+        auto const seen = this->state.load(std::memory_order_acquire);
+        if (tagPart(seen) != tagOf<T>())
+            return std::nullopt;
+        auto const raw = this->bits.load(std::memory_order_relaxed);
+        // Every store bumps the generation, so an unchanged state means the bits were not replaced (not
+        // even by a store of another type followed by one of T again) while they were read.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (this->state.load(std::memory_order_relaxed) != seen)
+            return std::nullopt;
+        T v;
+        std::memcpy(&v, &raw, sizeof(T));
+        return v;
+    }
+    template <typename T>
+    void store(T v) const
+    {
+        auto expected = this->state.load(std::memory_order_relaxed);
+        if (tagPart(expected) == busy || tagPart(expected) == tagOf<T>())
+            return;
+        auto const generation = (expected & ~tag_mask) + (tag_mask + 1);
+        if (!this->state.compare_exchange_strong(expected, generation | busy, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+        std::atomic_thread_fence(std::memory_order_release);
+        std::uint64_t raw = 0;
+        std::memcpy(&raw, &v, sizeof(T));
+        this->bits.store(raw, std::memory_order_relaxed);
+        this->state.store(generation | tagOf<T>(), std::memory_order_release);
+    }
+private:
+    // state: a generation count above the low byte, which holds the tag of the cached type.
+    static constexpr std::uint64_t tag_mask = 0xff;
+    static constexpr std::uint8_t tagPart(std::uint64_t state)
+    {
+        return static_cast<std::uint8_t>(state & tag_mask);
+    }
+    static constexpr std::uint8_t empty = 0;
+    static constexpr std::uint8_t busy = 1;
+    template <typename T, typename... Ts>
+    static constexpr std::uint8_t tagIn()
+    {
+        std::uint8_t tag = 2;
+        ((std::is_same_v<T, Ts> ? false : (++tag, true)) && ...);
+        return tag;
+    }
+    template <typename T>
+    static constexpr std::uint8_t tagOf()
+    {
+        return tagIn<T, bool, char, signed char, unsigned char, wchar_t, char8_t, char16_t, char32_t,
+                     short, unsigned short, int, unsigned int, long, unsigned long, long long, unsigned long long,
+                     float, double>();
+    }
+
+    mutable std::atomic<std::uint64_t> state{ empty };
+    mutable std::atomic<std::uint64_t> bits{ 0 };
+};
+
+// A field's value plus its typed cache.
+class FieldValue final
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    FieldValue() = default;
+    explicit FieldValue(allocator_type alloc) : text(alloc) {}
+    explicit FieldValue(std::string_view sv, allocator_type alloc = {}) : text(sv, alloc) {}
+    explicit FieldValue(ConfigString&& cs, allocator_type alloc = {}) : text(std::move(cs), alloc) {}
+    FieldValue(FieldValue const& other) = default;
+    FieldValue(FieldValue&& other) = default;
+    FieldValue(FieldValue const& other, allocator_type alloc) : text(other.text, alloc) {}
+    FieldValue(FieldValue&& other, allocator_type alloc) : text(std::move(other.text), alloc) {}
+    FieldValue& operator=(FieldValue const& other) = default;
+    FieldValue& operator=(FieldValue&& other) = default;
+
+    void assign(std::string_view sv)
+    {
+        this->text.assign(sv);
+        this->cache.clear();
+    }
+    void assignBorrowed(std::string_view sv)
+    {
+        this->text.assignBorrowed(sv);
+        this->cache.clear();
+    }
+    std::string_view view() const
+    {
+        return this->text.view();
+    }
+    template <typename T>
+    std::optional<T> getAsCached() const
+    {
+        if constexpr (TypedValueCache::cacheable<T>) {
+            if (auto const cached = this->cache.template load<T>())
+                return cached;
+            auto const v = parse<T>(this->view());
+            this->cache.store(v);
+            return v;
+        }
+        else {
+            return parse<T>(this->view());
+        }
+    }
+private:
+    ConfigString text;
+    TypedValueCache cache;
+};
+
+// Handle to a field resolved once through ConfigTable::resolve or Section::resolveField; reads through it
+// do no hashing and no string construction. It stays valid, and sees later setField updates to the same
+// key, for as long as the owning Section lives.
+// A field that did not exist at resolve time stays empty.
+class FieldRef final
+{
+public:
+    FieldRef() = default;
+    explicit FieldRef(FieldValue const* value) : value(value) {}
+
+    explicit operator bool() const
+    {
+        return this->value != nullptr;
+    }
+    std::optional<std::string_view> get() const
+    {
+        if (this->value == nullptr)
+            return std::nullopt;
+        else
+            return this->value->view();
+    }
+    template <typename T>
+    std::optional<T> getAs() const
+    {
+        return parse<T>(this->get());
+    }
+#if ACFP_HAS_EXPECTED
+    // Non-throwing getAs (see Section::tryGetFieldAs).
+    template <typename T>
+    std::expected<T, ConvertError> tryGetAs() const
+    {
+        if (this->value == nullptr)
+            return std::unexpected(ConvertError{ ConvertError::Code::MissingField });
+        return tryParse<T>(this->value->view());
+    }
+#endif
+    // Like getAs, but goes through the field's typed cache (see TypedValueCache).
+    template <typename T>
+    std::optional<T> getAsCached() const
+    {
+        if (this->value == nullptr)
+            return std::nullopt;
+        else
+            return this->value->getAsCached<T>();
+    }
+private:
+    FieldValue const* value = nullptr;
+};
+
 class Section final
 {
+    using FieldMap = std::pmr::unordered_map<ConfigString, FieldValue, StringHash, StringEqual>;
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+    using const_iterator = EntryIterator<FieldMap::const_iterator, std::string_view>;
+
+    Section() = default;
+    explicit Section(allocator_type alloc) : fields(alloc) {}
+    Section(Section const& other) = default;
+    Section(Section&& other) = default;
+    Section(Section const& other, allocator_type alloc) : fields(other.fields, alloc) {}
+    Section(Section&& other, allocator_type alloc) : fields(std::move(other.fields), alloc) {}
+    Section& operator=(Section const& other) = default;
+    Section& operator=(Section&& other) = default;
+
     bool hasField(std::string_view key) const
     {
-        return this->fields.count(std::string{ key }) != 0;
+        return this->fields.contains(key);
     }
     std::optional<std::string_view> getField(std::string_view key) const
     {
-        auto it = this->fields.find(std::string{ key });
+        auto it = this->fields.find(key);
         if (it == this->fields.end())
             return std::nullopt;
         else
-            return std::string_view{ it->second };
+            return it->second.view();
     }
     template <typename T>
     std::optional<T> getFieldAs(std::string_view key) const
     {
         return parse<T>(this->getField(key));
     }
+#if ACFP_HAS_EXPECTED
+    // Non-throwing getFieldAs: a missing key is ConvertError::Code::MissingField.
+    template <typename T>
+    std::expected<T, ConvertError> tryGetFieldAs(std::string_view key) const
+    {
+        auto const value = this->getField(key);
+        if (!value)
+            return std::unexpected(ConvertError{ ConvertError::Code::MissingField });
+        return tryParse<T>(*value);
+    }
+    // The field as a T, or default_value when it is missing or does not convert.
+    template <typename T>
+    T getFieldOr(std::string_view key, T default_value) const
+    {
+        return this->tryGetFieldAs<T>(key).value_or(std::move(default_value));
+    }
+#endif
+    // Like getFieldAs, but repeated reads as the same T return the cached result instead of re-parsing.
+    template <typename T>
+    std::optional<T> getFieldAsCached(std::string_view key) const
+    {
+        auto it = this->fields.find(key);
+        if (it == this->fields.end())
+            return std::nullopt;
+        else
+            return it->second.getAsCached<T>();
+    }
+    FieldRef resolveField(std::string_view key) const
+    {
+        auto it = this->fields.find(key);
+        if (it == this->fields.end())
+            return FieldRef{};
+        else
+            return FieldRef{ &it->second };
+    }
     void setField(std::string_view key, std::string_view value)
     {
-        this->fields[std::string{ key }] = std::string{ value };
+        auto it = this->fields.find(key);
+        if (it == this->fields.end())
+            this->fields.emplace(key, value);
+        else
+            it->second.assign(value);
+    }
+    // Like setField, but stores views of key and value; the caller guarantees the bytes outlive this Section.
+    void setFieldBorrowed(std::string_view key, std::string_view value)
+    {
+        auto it = this->fields.find(key);
+        if (it == this->fields.end())
+            this->fields.emplace(ConfigString::borrow(key), FieldValue{ ConfigString::borrow(value) });
+        else
+            it->second.assignBorrowed(value);
     }
     std::optional<std::string_view> operator[](std::string_view key) const
     {
         return this->getField(key);
     }
     void iterate(std::function<void(std::string_view, std::string_view)> cb) const
+    {
+        this->forEach(cb);
+    }
+    // Calls f(key, value) for every field, in unspecified order.
+    template <typename F>
+    void forEach(F&& f) const
     {
         for (auto const& kv : this->fields) {
-            cb(kv.first, kv.second);
+            f(kv.first.view(), kv.second.view());
+        }
+    }
+    const_iterator begin() const
+    {
+        return const_iterator{ this->fields.begin() };
+    }
+    const_iterator end() const
+    {
+        return const_iterator{ this->fields.end() };
+    }
+    std::size_t size() const
+    {
+        return this->fields.size();
+    }
+    bool empty() const
+    {
+        return this->fields.empty();
+    }
+    // Applies other's fields over this section's, as if other's lines followed ours (last write wins).
+    // Borrowed strings stay borrowed.
+    void merge(Section const& other)
+    {
+        for (auto const& [key, value] : other.fields) {
+            auto it = this->fields.find(key.view());
+            if (it == this->fields.end())
+                this->fields.emplace(key, value);
+            else
+                it->second = value;
         }
     }
 private:
-    std::unordered_map<std::string, std::string> fields;
+    FieldMap fields;
 };
 
+// Subsections are held by shared_ptr so that they can be shared between groups on request (shareSubsection
+// and adoptSubsection, mergeShared); copying a group always deep-copies its Sections.  A shared Section is
+// copy-on-write: the first mutable access through getSubsection in any group that shares it clones it.
 class SectionGroup final
 {
+    using SectionMap = std::pmr::unordered_map<std::pmr::string, std::shared_ptr<Section>, StringHash, StringEqual>;
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+    using const_iterator = EntryIterator<SectionMap::const_iterator, Section const&>;
+
+    SectionGroup() = default;
+    explicit SectionGroup(allocator_type alloc) : sections(alloc) {}
+    SectionGroup(SectionGroup const& other) : SectionGroup(other, allocator_type{}) {}
+    SectionGroup(SectionGroup&& other) = default;
+    SectionGroup(SectionGroup const& other, allocator_type alloc) : sections(alloc)
+    {
+        this->copyFrom(other);
+    }
+    SectionGroup(SectionGroup&& other, allocator_type alloc) : sections(alloc)
+    {
+        if (other.sections.get_allocator() == alloc)
+            this->sections = std::move(other.sections);
+        else
+            this->copyFrom(other);
+    }
+    SectionGroup& operator=(SectionGroup const& other)
+    {
+        if (this != &other) {
+            this->sections.clear();
+            this->copyFrom(other);
+        }
+        return *this;
+    }
+    SectionGroup& operator=(SectionGroup&& other)
+    {
+        if (this->sections.get_allocator() == other.sections.get_allocator()) {
+            this->sections = std::move(other.sections);
+        }
+        else if (this != &other) {
+            this->sections.clear();
+            this->copyFrom(other);
+        }
+        return *this;
+    }
+
     bool hasSubsection(std::string_view subkey) const
     {
-        return this->sections.count(std::string{ subkey }) != 0;
+        return this->sections.contains(subkey);
     }
     Section const& getSubsection(std::string_view subkey) const
     {
@@ -144,27 +740,136 @@ public:
     }
     Section& getSubsection(std::string_view subkey)
     {
-        return this->sections[std::string{ subkey }];
+        auto it = this->sections.find(subkey);
+        if (it == this->sections.end())
+            it = this->sections.emplace(std::piecewise_construct, std::forward_as_tuple(subkey), std::forward_as_tuple(this->makeSection())).first;
+        else if (it->second.use_count() > 1)
+            it->second = this->makeSection(*it->second);
+        else
+            std::atomic_thread_fence(std::memory_order_acquire); // pairs with the release of the last other owner
+        return *it->second;
     }
     Section const& operator[](std::string_view subkey) const
     {
         static const Section empty_section;
-        auto it = this->sections.find(std::string{ subkey });
+        auto it = this->sections.find(subkey);
         if (it == this->sections.end())
             return empty_section;
+        else
+            return *it->second;
+    }
+    // The subsection itself (null if absent), for sharing it with another group through adoptSubsection.
+    // While it is shared, writing to it through this group clones it first, so references and FieldRefs
+    // taken from this group beforehand stop seeing those writes.
+    std::shared_ptr<Section const> shareSubsection(std::string_view subkey) const
+    {
+        auto it = this->sections.find(subkey);
+        if (it == this->sections.end())
+            return nullptr;
         else
             return it->second;
     }
+    // Inserts or replaces a subsection without copying it; it is cloned on the first mutable access while
+    // shared.  Its memory must come from a resource that outlives this group (e.g. the default resource).
+    void adoptSubsection(std::string_view subkey, std::shared_ptr<Section const> section)
+    {
+        auto shared = std::const_pointer_cast<Section>(std::move(section));
+        auto it = this->sections.find(subkey);
+        if (it == this->sections.end())
+            this->sections.emplace(std::piecewise_construct, std::forward_as_tuple(subkey), std::forward_as_tuple(std::move(shared)));
+        else
+            it->second = std::move(shared);
+    }
+    // Calls f(subkey, section) for every subsection, in unspecified order.
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (auto const& kv : this->sections) {
+            f(std::string_view{ kv.first }, std::as_const(*kv.second));
+        }
+    }
+    const_iterator begin() const
+    {
+        return const_iterator{ this->sections.begin() };
+    }
+    const_iterator end() const
+    {
+        return const_iterator{ this->sections.end() };
+    }
+    std::size_t size() const
+    {
+        return this->sections.size();
+    }
+    bool empty() const
+    {
+        return this->sections.empty();
+    }
+    void merge(SectionGroup const& other)
+    {
+        for (auto const& [subkey, section] : other.sections)
+            this->getSubsection(subkey).merge(*section);
+    }
+    // As merge, but subsections this group lacks are shared with other instead of copied (when both live
+    // on the same memory resource); see shareSubsection.
+    void mergeShared(SectionGroup const& other)
+    {
+        for (auto const& [subkey, section] : other.sections) {
+            if (!this->hasSubsection(subkey) && this->sections.get_allocator() == other.sections.get_allocator())
+                this->adoptSubsection(subkey, section);
+            else
+                this->getSubsection(subkey).merge(*section);
+        }
+    }
 private:
-    std::unordered_map<std::string, Section> sections;
+    template <typename... Args>
+    std::shared_ptr<Section> makeSection(Args const&... args) const
+    {
+        return std::allocate_shared<Section>(std::pmr::polymorphic_allocator<Section>{ this->sections.get_allocator() }, args...);
+    }
+    void copyFrom(SectionGroup const& other)
+    {
+        for (auto const& [subkey, section] : other.sections)
+            this->sections.emplace(std::piecewise_construct, std::forward_as_tuple(subkey), std::forward_as_tuple(this->makeSection(*section)));
+    }
+
+    SectionMap sections;
 };
 
 class ConfigTable final
 {
+    using GroupMap = std::pmr::unordered_map<std::pmr::string, SectionGroup, StringHash, StringEqual>;
 public:
+    using const_iterator = EntryIterator<GroupMap::const_iterator, SectionGroup const&>;
+
+    // Requests that the table own a monotonic arena: every key, value, section name and map node lives
+    // in a few large blocks, which are released together when the table is destroyed.
+    struct Arena
+    {
+        std::size_t initial_size = 64 * 1024;
+    };
+
+    ConfigTable() = default;
+    explicit ConfigTable(Arena arena)
+        : arena(std::make_unique<std::pmr::monotonic_buffer_resource>(arena.initial_size))
+        , groups(this->arena.get())
+    {}
+    // Allocates from a caller-managed resource, which must outlive the table.
+    explicit ConfigTable(std::pmr::memory_resource* resource) : groups(resource) {}
+    // Copies are made on the default resource; they do not share or copy the source's arena.
+    ConfigTable(ConfigTable const& other) : groups(other.groups), buffers(other.buffers) {}
+    ConfigTable(ConfigTable&& other) noexcept = default;
+    ConfigTable& operator=(ConfigTable other) noexcept
+    {
+        // pmr maps cannot take over another allocator by assignment or swap, so rebuild in place
+        // from the moved-in table (which carries its arena along with its nodes).
+        std::destroy_at(this);
+        std::construct_at(this, std::move(other));
+        return *this;
+    }
+
     bool hasSection(std::string_view key) const
     {
-        return this->groups.count(std::string{ key }) != 0;
+        return this->groups.contains(key);
     }
     SectionGroup const& getSection(std::string_view key) const
     {
@@ -172,150 +877,3279 @@ public:
     }
     SectionGroup& getSection(std::string_view key)
     {
-        return this->groups[std::string{ key }];
+        auto it = this->groups.find(key);
+        if (it == this->groups.end())
+            it = this->groups.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+        return it->second;
     }
     SectionGroup const& operator[](std::string_view key) const
     {
         static const SectionGroup empty_section_group;
-        auto it = this->groups.find(std::string{ key });
+        auto it = this->groups.find(key);
         if (it == this->groups.end())
             return empty_section_group;
         else
             return it->second;
     }
-private:
-    std::unordered_map<std::string, SectionGroup> groups;
-};
+    FieldRef resolve(std::string_view key, std::string_view subkey, std::string_view field) const
+    {
+        return this->operator[](key)[subkey].resolveField(field);
+    }
+    // Keeps a buffer that borrowed keys/values point into alive for the lifetime of this table (and its copies).
+    void retainBuffer(std::shared_ptr<void const> buffer)
+    {
+        this->buffers.push_back(std::move(buffer));
+    }
+    // Calls f(key, group) for every section group, in unspecified order.
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (auto const& kv : this->groups) {
+            f(std::string_view{ kv.first }, kv.second);
+        }
+    }
+    const_iterator begin() const
+    {
+        return const_iterator{ this->groups.begin() };
+    }
+    const_iterator end() const
+    {
+        return const_iterator{ this->groups.end() };
+    }
+    std::size_t size() const
+    {
+        return this->groups.size();
+    }
+    bool empty() const
+    {
+        return this->groups.empty();
+    }
+    // Applies other's fields over this table's, as if other's lines followed ours (last write wins).
+    void merge(ConfigTable const& other)
+    {
+        for (auto const& [key, group] : other.groups)
+            this->getSection(key).merge(group);
+        this->buffers.insert(this->buffers.end(), other.buffers.begin(), other.buffers.end());
+    }
+    // As merge, but shares the subsections this table lacks with other instead of copying them (see
+    // SectionGroup::shareSubsection).
+    void mergeShared(ConfigTable const& other)
+    {
+        for (auto const& [key, group] : other.groups)
+            this->getSection(key).mergeShared(group);
+        this->buffers.insert(this->buffers.end(), other.buffers.begin(), other.buffers.end());
+    }
+private:
+    // Declared before groups so that it outlives every node allocated from it.
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    GroupMap groups;
+    std::vector<std::shared_ptr<void const>> buffers;
+};
+
+struct ConfigBindError
+{
+    enum class Kind
+    {
+        Missing,
+        Invalid,
+    };
+    std::string key;
+    Kind kind;
+    std::string message;
+};
+// Thrown by ConfigBinding with every problem found in the section, not just the first.
+class ConfigBindException : public std::runtime_error
+{
+public:
+    ConfigBindException(std::vector<ConfigBindError> errors)
+        : std::runtime_error(describe(errors))
+        , bind_errors(std::move(errors))
+    {}
+    std::vector<ConfigBindError> const& errors() const
+    {
+        return this->bind_errors;
+    }
+private:
+    static std::string describe(std::vector<ConfigBindError> const& errors)
+    {
+        std::string msg = "Could not bind section:";
+        for (auto const& error : errors) {
+            msg += "\n  ";
+            msg += error.message;
+        }
+        return msg;
+    }
+    std::vector<ConfigBindError> bind_errors;
+};
 
+// One member of a ConfigBinding: the key it is read from and, for optional keys, its default.
+template <typename Struct, typename T>
+struct BoundField
+{
+    std::string_view key;
+    T Struct::* member;
+    std::optional<T> default_value;
+};
+// A required key.
+template <typename Struct, typename T>
 inline
-void trimStringViewEnds(std::string_view& sv, std::string_view const trim_chars = std::string_view{ " \t" })
+BoundField<Struct, T> bindField(std::string_view key, T Struct::* member)
 {
-    auto fnos = sv.find_first_not_of(trim_chars);
-    if (fnos != std::string_view::npos)
-        sv.remove_prefix(fnos);
-    auto lnos = sv.find_last_not_of(trim_chars);
-    if (lnos != std::string_view::npos)
-        sv.remove_suffix(sv.size() - (lnos + 1));
+    return BoundField<Struct, T>{ key, member, std::nullopt };
 }
+// An optional key, default_value being used when it is absent.
+template <typename Struct, typename T, typename U>
 inline
-std::size_t findFirstNotQuoted(std::string_view sv, char ch)
+BoundField<Struct, T> bindField(std::string_view key, T Struct::* member, U&& default_value)
 {
-    bool quoted = false;
-    bool escaped = false;
+    return BoundField<Struct, T>{ key, member, T(std::forward<U>(default_value)) };
+}
 
-    for (std::size_t p = 0 ; p < sv.size() ; p++) {
-        if (sv[p] == '\\') {
-            escaped = !escaped;
+// Declarative mapping from a Section's keys onto the members of Struct:
+//
+//     static const ACFP::ConfigBinding db_binding{
+//         ACFP::bindField("host", &DbSettings::host),
+//         ACFP::bindField("port", &DbSettings::port, 5432),
+//     };
+//     auto const db = db_binding.bind(ct["database"]["primary"]);
+//
+// bind makes one pass over the section's fields, dispatching each bound key straight to the Parser of
+// its member's type, and reports all missing and unparseable keys together in one ConfigBindException.
+// Keys the binding does not know are ignored.
+template <typename Struct, typename... Ts>
+class ConfigBinding final
+{
+public:
+    explicit ConfigBinding(BoundField<Struct, Ts>... fields) : fields(std::move(fields)...)
+    {
+        std::size_t i = 0;
+        std::apply([&](auto const&... field) { ((this->by_key[i] = KeyIndex{ field.key, i }, i++), ...); }, this->fields);
+        std::ranges::sort(this->by_key);
+        if (std::ranges::adjacent_find(this->by_key, {}, &KeyIndex::first) != this->by_key.end())
+            throw std::invalid_argument("ConfigBinding binds the same key twice");
+    }
+
+    Struct bind(Section const& section) const
+    {
+        Struct out{};
+        this->bindInto(section, out);
+        return out;
+    }
+    // Members whose key is missing (and has no default) or does not parse are left untouched.
+    void bindInto(Section const& section, Struct& out) const
+    {
+        std::array<bool, field_count> seen{};
+        std::vector<std::pair<std::size_t, ConfigBindError>> errors;
+        section.forEach([&](std::string_view key, std::string_view value) {
+            auto const it = std::ranges::lower_bound(this->by_key, key, {}, &KeyIndex::first);
+            if (it == this->by_key.end() || it->first != key)
+                return;
+            seen[it->second] = true;
+            if (auto error = setters[it->second](*this, out, value))
+                errors.emplace_back(it->second, std::move(*error));
+        });
+        for (std::size_t i = 0 ; i < field_count ; i++) {
+            if (seen[i])
+                continue;
+            if (auto error = defaulters[i](*this, out))
+                errors.emplace_back(i, std::move(*error));
         }
-        else if (sv[p] == '"') {
-            if (quoted) {
-                if (!escaped)
-                    quoted = false;
-            }
-            else {
-                if (!escaped)
-                    quoted = true;
-            }
-            escaped = false;
+        if (errors.empty())
+            return;
+        // Report in declaration order rather than the section's hash order.
+        std::ranges::sort(errors, {}, &std::pair<std::size_t, ConfigBindError>::first);
+        std::vector<ConfigBindError> result;
+        result.reserve(errors.size());
+        for (auto& [i, error] : errors)
+            result.push_back(std::move(error));
+        throw ConfigBindException(std::move(result));
+    }
+private:
+    static constexpr std::size_t field_count = sizeof...(Ts);
+    using KeyIndex = std::pair<std::string_view, std::size_t>;
+    using Setter = std::optional<ConfigBindError> (*)(ConfigBinding const&, Struct&, std::string_view);
+    using Defaulter = std::optional<ConfigBindError> (*)(ConfigBinding const&, Struct&);
+
+    template <std::size_t I>
+    static std::optional<ConfigBindError> set(ConfigBinding const& self, Struct& out, std::string_view value)
+    {
+        auto const& field = std::get<I>(self.fields);
+        using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+        try {
+            out.*field.member = parse<T>(value);
         }
-        else if (sv[p] == ch) {
-            if (!escaped && !quoted)
-                return p;
+        catch (ConfigValueConvertException const& e) {
+            return ConfigBindError{ std::string{ field.key }, ConfigBindError::Kind::Invalid, std::format("Field '{}': {}", field.key, e.what()) };
         }
+        return std::nullopt;
     }
-    return std::string_view::npos;
-}
+    template <std::size_t I>
+    static std::optional<ConfigBindError> setDefault(ConfigBinding const& self, Struct& out)
+    {
+        auto const& field = std::get<I>(self.fields);
+        if (!field.default_value)
+            return ConfigBindError{ std::string{ field.key }, ConfigBindError::Kind::Missing, std::format("Missing required field '{}'", field.key) };
+        out.*field.member = *field.default_value;
+        return std::nullopt;
+    }
+    static constexpr auto setters = []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array<Setter, field_count>{ &set<Is>... };
+    }(std::index_sequence_for<Ts...>{});
+    static constexpr auto defaulters = []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array<Defaulter, field_count>{ &setDefault<Is>... };
+    }(std::index_sequence_for<Ts...>{});
 
-inline
-void trimStringComment(std::string_view& sv)
+    std::tuple<BoundField<Struct, Ts>...> fields;
+    // Keys sorted for the binary search in bindInto, with their declaration index.
+    std::array<KeyIndex, field_count> by_key;
+};
+
+// FNV-1a; used wherever a hash must be stable across processes and builds.
+constexpr
+std::uint32_t fnv1a32(std::string_view sv)
 {
-    auto p = sv.find_first_of("#/");
-    if (p != std::string_view::npos) {
-        if (sv[p] == '#')
-            sv.remove_suffix(sv.size() - p);
-        else if (sv[p] == '/' && sv.size() > p + 1 && sv[p+1] == '/') {
-            sv.remove_suffix(sv.size() - p);
-        }
+    std::uint32_t h = 2166136261u;
+    for (char const c : sv) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
     }
+    return h;
 }
 inline
-void trimStringQuotes(std::string_view& sv, uint16_t line_num, char front = '"', char back = '"')
+std::uint64_t fnv1a64(std::span<std::byte const> bytes)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (auto const b : bytes) {
+        h ^= static_cast<std::uint8_t>(b);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// One entry of a frozen table: a group, a subsection or a field.
+// Entries of one level are contiguous and sorted by (hash, name), so a lookup is a binary search over
+// 20-byte records that only touches the string pool to confirm a hash match.
+struct FrozenRecord
+{
+    std::uint32_t hash;
+    std::uint32_t name_offset;
+    std::uint32_t name_size;
+    // Groups/subsections: index and count of their children.  Fields: offset and size of the value.
+    std::uint32_t first;
+    std::uint32_t count;
+};
+struct FrozenHeader
+{
+    std::uint32_t group_count;
+    std::uint32_t section_count;
+    std::uint32_t field_count;
+    std::uint32_t pool_size;
+};
+
+// Handle to a field of a FrozenConfigTable; valid for as long as the table (or a copy of it) lives.
+class FrozenFieldRef final
+{
+public:
+    FrozenFieldRef() = default;
+    FrozenFieldRef(FrozenRecord const* field, char const* pool) : field(field), pool(pool) {}
+
+    explicit operator bool() const
+    {
+        return this->field != nullptr;
+    }
+    std::optional<std::string_view> get() const
+    {
+        if (this->field == nullptr)
+            return std::nullopt;
+        else
+            return std::string_view{ this->pool + this->field->first, this->field->count };
+    }
+    template <typename T>
+    std::optional<T> getAs() const
+    {
+        return parse<T>(this->get());
+    }
+private:
+    FrozenRecord const* field = nullptr;
+    char const* pool = nullptr;
+};
+
+class FrozenSection final
 {
-    if (sv.front() == front) {
-        sv.remove_prefix(1);
-        if (sv.size() == 0 || sv.back() != back) {
-            throw ConfigFileParseException(std::format("Unfished quoted string on line {}: '{}'", line_num, sv));
+public:
+    FrozenSection() = default;
+    FrozenSection(FrozenRecord const* fields, std::uint32_t count, char const* pool) : fields(fields), count(count), pool(pool) {}
+
+    bool hasField(std::string_view key) const
+    {
+        return this->find(key) != nullptr;
+    }
+    std::optional<std::string_view> getField(std::string_view key) const
+    {
+        auto const* rec = this->find(key);
+        if (rec == nullptr)
+            return std::nullopt;
+        else
+            return std::string_view{ this->pool + rec->first, rec->count };
+    }
+    template <typename T>
+    std::optional<T> getFieldAs(std::string_view key) const
+    {
+        return parse<T>(this->getField(key));
+    }
+    FrozenFieldRef resolveField(std::string_view key) const
+    {
+        auto const* rec = this->find(key);
+        if (rec == nullptr)
+            return FrozenFieldRef{};
+        else
+            return FrozenFieldRef{ rec, this->pool };
+    }
+    std::optional<std::string_view> operator[](std::string_view key) const
+    {
+        return this->getField(key);
+    }
+    void iterate(std::function<void(std::string_view, std::string_view)> cb) const
+    {
+        for (std::uint32_t i = 0 ; i < this->count ; i++) {
+            auto const& rec = this->fields[i];
+            cb(std::string_view{ this->pool + rec.name_offset, rec.name_size }, std::string_view{ this->pool + rec.first, rec.count });
         }
-        sv.remove_suffix(1);
     }
+private:
+    FrozenRecord const* find(std::string_view key) const;
+
+    FrozenRecord const* fields = nullptr;
+    std::uint32_t count = 0;
+    char const* pool = nullptr;
+};
+
+class FrozenSectionGroup final
+{
+public:
+    FrozenSectionGroup() = default;
+    FrozenSectionGroup(FrozenRecord const* sections, std::uint32_t count, FrozenRecord const* fields, char const* pool)
+        : sections(sections), count(count), fields(fields), pool(pool) {}
+
+    bool hasSubsection(std::string_view subkey) const
+    {
+        return this->find(subkey) != nullptr;
+    }
+    FrozenSection getSubsection(std::string_view subkey) const
+    {
+        return this->operator[](subkey);
+    }
+    FrozenSection operator[](std::string_view subkey) const
+    {
+        auto const* rec = this->find(subkey);
+        if (rec == nullptr)
+            return FrozenSection{};
+        else
+            return FrozenSection{ this->fields + rec->first, rec->count, this->pool };
+    }
+private:
+    FrozenRecord const* find(std::string_view subkey) const;
+
+    FrozenRecord const* sections = nullptr;
+    std::uint32_t count = 0;
+    FrozenRecord const* fields = nullptr;
+    char const* pool = nullptr;
+};
+
+inline
+FrozenRecord const* findFrozenRecord(FrozenRecord const* first, std::uint32_t count, char const* pool, std::string_view name)
+{
+    auto const hash = fnv1a32(name);
+    auto const* last = first + count;
+    auto const* it = std::lower_bound(first, last, hash, [](FrozenRecord const& rec, std::uint32_t h) { return rec.hash < h; });
+    for ( ; it != last && it->hash == hash ; ++it) {
+        if (std::string_view{ pool + it->name_offset, it->name_size } == name)
+            return it;
+    }
+    return nullptr;
 }
 inline
-std::size_t findEqPos(std::string_view line)
+FrozenRecord const* FrozenSection::find(std::string_view key) const
 {
-    return findFirstNotQuoted(line, '=');
+    return findFrozenRecord(this->fields, this->count, this->pool, key);
+}
+inline
+FrozenRecord const* FrozenSectionGroup::find(std::string_view subkey) const
+{
+    return findFrozenRecord(this->sections, this->count, this->pool, subkey);
 }
 
+// Checks that a frozen image's header, record ranges and string offsets are all in bounds.
 inline
-ConfigTable parseConfigFile(std::istream& is)
+void validateFrozenImage(std::span<std::byte const> image)
+{
+    FrozenHeader header;
+    if (image.size() < sizeof(header))
+        throw ConfigImageException("Config image truncated");
+    std::memcpy(&header, image.data(), sizeof(header));
+    auto const records = std::uint64_t{ header.group_count } + header.section_count + header.field_count;
+    if (sizeof(header) + records * sizeof(FrozenRecord) + header.pool_size != image.size())
+        throw ConfigImageException("Config image size does not match its header");
+    auto const* recs = reinterpret_cast<FrozenRecord const*>(image.data() + sizeof(header));
+    auto const in_range = [](std::uint64_t first, std::uint64_t count, std::uint64_t limit) {
+        return first + count <= limit;
+    };
+    for (std::uint64_t i = 0 ; i < records ; i++) {
+        auto const& rec = recs[i];
+        bool ok = in_range(rec.name_offset, rec.name_size, header.pool_size);
+        if (i < header.group_count)
+            ok = ok && in_range(rec.first, rec.count, header.section_count);
+        else if (i < std::uint64_t{ header.group_count } + header.section_count)
+            ok = ok && in_range(rec.first, rec.count, header.field_count);
+        else
+            ok = ok && in_range(rec.first, rec.count, header.pool_size);
+        if (!ok)
+            throw ConfigImageException(std::format("Config image record {} out of bounds", i));
+    }
+}
+
+// Read-only, compacted copy of a ConfigTable: one string pool plus three flat record arrays
+// (groups, subsections, fields) in a single allocation, with the same read API as ConfigTable.
+// The image is position independent (offsets only), so it can also be served straight from a file or
+// shared memory; see serialize and loadConfigImage.
+class FrozenConfigTable final
 {
-    ConfigTable ct;
+public:
+    FrozenConfigTable() = default;
+    // Serves an existing image without copying it; owner keeps the bytes alive.  The image must be
+    // 4-byte aligned and either trusted or checked with validateFrozenImage.
+    FrozenConfigTable(std::span<std::byte const> image, std::shared_ptr<void const> owner)
+    {
+        if (image.size() < sizeof(FrozenHeader) || reinterpret_cast<std::uintptr_t>(image.data()) % alignof(FrozenRecord) != 0)
+            throw ConfigImageException("Config image too small or misaligned");
+        this->attach(image, std::move(owner));
+    }
+    explicit FrozenConfigTable(ConfigTable const& ct)
+    {
+        std::vector<FrozenRecord> group_recs;
+        std::vector<FrozenRecord> section_recs;
+        std::vector<FrozenRecord> field_recs;
+        std::string pool;
 
-    auto* cur_section = &ct.getSection("").getSubsection("");
-    std::string line_string;
-    for (uint32_t line_num = 1 ; std::getline(is, line_string) ; line_num++) {
-        std::string_view line = line_string;
-        // Trim Spaces from ends
-        trimStringViewEnds(line);
-        // Remove comments
-        trimStringComment(line);
-        // Skip empty lines
-        if (line.size() == 0)
-            continue;
-        // Figure out what kind of line this is
-        if (line.front() == '[') {
-            // Section start
-            trimStringQuotes(line, line_num, '[', ']');
-            auto const sep = findFirstNotQuoted(line, ' ');
-            if (sep == std::string_view::npos) {
-                // Singleton Section
-                auto const section_name = line;
-                cur_section = &ct.getSection(section_name).getSubsection("");
+        auto const add_string = [&pool](std::string_view sv) {
+            if (pool.size() + sv.size() > UINT32_MAX)
+                throw std::length_error("Config table too large to freeze");
+            auto const offset = static_cast<std::uint32_t>(pool.size());
+            pool.append(sv);
+            return offset;
+        };
+        auto const make_record = [&add_string](std::string_view name) {
+            return FrozenRecord{ fnv1a32(name), add_string(name), static_cast<std::uint32_t>(name.size()), 0, 0 };
+        };
+        auto const by_hash_then_name = [&pool](FrozenRecord const& lhs, FrozenRecord const& rhs) {
+            if (lhs.hash != rhs.hash)
+                return lhs.hash < rhs.hash;
+            return std::string_view{ pool.data() + lhs.name_offset, lhs.name_size } < std::string_view{ pool.data() + rhs.name_offset, rhs.name_size };
+        };
+        // Children are emitted level by level so each parent's children are contiguous.
+        std::vector<std::pair<FrozenRecord, SectionGroup const*>> groups;
+        for (auto const& [name, group] : ct)
+            groups.emplace_back(make_record(name), &group);
+        std::sort(groups.begin(), groups.end(), [&](auto const& lhs, auto const& rhs) { return by_hash_then_name(lhs.first, rhs.first); });
+
+        std::vector<Section const*> sections;
+        for (auto& [group_rec, group] : groups) {
+            std::vector<std::pair<FrozenRecord, Section const*>> subs;
+            for (auto const& [name, section] : *group)
+                subs.emplace_back(make_record(name), &section);
+            std::sort(subs.begin(), subs.end(), [&](auto const& lhs, auto const& rhs) { return by_hash_then_name(lhs.first, rhs.first); });
+            group_rec.first = static_cast<std::uint32_t>(section_recs.size());
+            group_rec.count = static_cast<std::uint32_t>(subs.size());
+            for (auto const& [rec, section] : subs) {
+                section_recs.push_back(rec);
+                sections.push_back(section);
             }
-            else {
-                auto section_name = line.substr(0, sep);
-                trimStringViewEnds(section_name);
-                trimStringQuotes(section_name, line_num);
-                auto section_subname = line.substr(sep + 1, std::string_view::npos);
-                trimStringViewEnds(section_subname);
-                trimStringQuotes(section_subname, line_num);
-                cur_section = &ct.getSection(section_name).getSubsection(section_subname);
+            group_recs.push_back(group_rec);
+        }
+        for (std::size_t i = 0 ; i < sections.size() ; i++) {
+            auto const first = field_recs.size();
+            for (auto const& [key, value] : *sections[i]) {
+                auto rec = make_record(key);
+                rec.first = add_string(value);
+                rec.count = static_cast<std::uint32_t>(value.size());
+                field_recs.push_back(rec);
             }
+            std::sort(field_recs.begin() + first, field_recs.end(), by_hash_then_name);
+            section_recs[i].first = static_cast<std::uint32_t>(first);
+            section_recs[i].count = static_cast<std::uint32_t>(field_recs.size() - first);
         }
-        else {
-            // Key/Value
-            auto const eq_pos = findEqPos(line);
-            if (eq_pos == std::string_view::npos)
-                throw ConfigFileParseException(std::format("Malformed line on line {}: '{}'", line_num, line));
-            auto key = line.substr(0, eq_pos);
-            trimStringViewEnds(key);
-            trimStringQuotes(key, line_num);
-            auto value = line.substr(eq_pos + 1, std::string_view::npos);
-            trimStringViewEnds(value);
-            trimStringQuotes(value, line_num);
 
-            cur_section->setField(std::string{ key }, std::string{ value });
-        }
+        FrozenHeader const header{
+            static_cast<std::uint32_t>(group_recs.size()),
+            static_cast<std::uint32_t>(section_recs.size()),
+            static_cast<std::uint32_t>(field_recs.size()),
+            static_cast<std::uint32_t>(pool.size()),
+        };
+        auto const image_size = sizeof(FrozenHeader) + sizeof(FrozenRecord) * (group_recs.size() + section_recs.size() + field_recs.size()) + pool.size();
+        auto storage = std::make_shared<std::vector<std::uint32_t>>((image_size + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t));
+        auto* out = reinterpret_cast<char*>(storage->data());
+        auto const append = [&out](void const* src, std::size_t size) {
+            if (size != 0)
+                std::memcpy(out, src, size);
+            out += size;
+        };
+        append(&header, sizeof(header));
+        append(group_recs.data(), sizeof(FrozenRecord) * group_recs.size());
+        append(section_recs.data(), sizeof(FrozenRecord) * section_recs.size());
+        append(field_recs.data(), sizeof(FrozenRecord) * field_recs.size());
+        append(pool.data(), pool.size());
+        std::span<std::byte const> const image{ reinterpret_cast<std::byte const*>(storage->data()), image_size };
+        this->attach(image, std::move(storage));
     }
 
-    return ct;
-}
+    bool hasSection(std::string_view key) const
+    {
+        return findFrozenRecord(this->groups, this->group_count, this->pool, key) != nullptr;
+    }
+    FrozenSectionGroup getSection(std::string_view key) const
+    {
+        return this->operator[](key);
+    }
+    FrozenSectionGroup operator[](std::string_view key) const
+    {
+        auto const* rec = findFrozenRecord(this->groups, this->group_count, this->pool, key);
+        if (rec == nullptr)
+            return FrozenSectionGroup{};
+        else
+            return FrozenSectionGroup{ this->sections + rec->first, rec->count, this->fields, this->pool };
+    }
+    FrozenFieldRef resolve(std::string_view key, std::string_view subkey, std::string_view field) const
+    {
+        return this->operator[](key)[subkey].resolveField(field);
+    }
+    // The underlying image: FrozenHeader, group records, subsection records, field records, string pool.
+    std::span<std::byte const> image() const
+    {
+        return this->bytes;
+    }
+private:
+    void attach(std::span<std::byte const> image, std::shared_ptr<void const> owner)
+    {
+        FrozenHeader header;
+        std::memcpy(&header, image.data(), sizeof(header));
+        this->bytes = image;
+        this->groups = reinterpret_cast<FrozenRecord const*>(image.data() + sizeof(FrozenHeader));
+        this->sections = this->groups + header.group_count;
+        this->fields = this->sections + header.section_count;
+        this->pool = reinterpret_cast<char const*>(this->fields + header.field_count);
+        this->group_count = header.group_count;
+        this->storage = std::move(owner);
+    }
+
+    std::shared_ptr<void const> storage;
+    std::span<std::byte const> bytes;
+    FrozenRecord const* groups = nullptr;
+    FrozenRecord const* sections = nullptr;
+    FrozenRecord const* fields = nullptr;
+    char const* pool = nullptr;
+    std::uint32_t group_count = 0;
+};
+
 inline
-ConfigTable  parseConfigFile(std::filesystem::path filename)
+FrozenConfigTable freeze(ConfigTable const& ct)
 {
-    std::ifstream ifs;
-    ifs.exceptions(std::ios_base::badbit);
-    ifs.open(filename);
-    return parseConfigFile(ifs);
+    return FrozenConfigTable{ ct };
+}
+
+// String literal usable as a template argument, e.g. ConfigSchema<"server.port">.
+template <std::size_t N>
+struct FixedString
+{
+    char chars[N] = {};
+    constexpr FixedString(char const (&str)[N])
+    {
+        std::copy_n(str, N, this->chars);
+    }
+    constexpr std::string_view view() const
+    {
+        return std::string_view{ this->chars, N - 1 };
+    }
+};
+
+// A field path: "group.key" for the group's unnamed subsection, "group sub.key" otherwise.
+// The key is everything after the first '.' that follows the group (and subsection) name.
+struct SchemaPath
+{
+    std::string_view group;
+    std::string_view subsection;
+    std::string_view field;
+};
+constexpr
+SchemaPath parseSchemaPath(std::string_view path)
+{
+    auto const group_end = path.find_first_of(" .");
+    if (group_end == std::string_view::npos)
+        throw std::invalid_argument("Schema path has no '.': expected \"group.key\" or \"group sub.key\"");
+    SchemaPath result{ path.substr(0, group_end), std::string_view{}, std::string_view{} };
+    auto field_start = group_end + 1;
+    if (path[group_end] == ' ') {
+        auto const sub_end = path.find('.', field_start);
+        if (sub_end == std::string_view::npos)
+            throw std::invalid_argument("Schema path has no '.': expected \"group.key\" or \"group sub.key\"");
+        result.subsection = path.substr(field_start, sub_end - field_start);
+        field_start = sub_end + 1;
+    }
+    result.field = path.substr(field_start);
+    return result;
+}
+
+// Seeded 32-bit FNV-1a with a final avalanche, so that nearby seeds give unrelated hashes.
+constexpr
+std::uint32_t schemaHash(std::string_view sv, std::uint32_t seed)
+{
+    std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char const c : sv) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
 }
 
+// A set of field paths known at compile time, with a minimal perfect hash over them generated at
+// compile time (hash and displace: one seed per bucket, chosen so that every path gets its own slot).
+// Keys are numbered in declaration order; see SchemaTable for lookups against a frozen table.
+template <FixedString... Paths>
+class ConfigSchema final
+{
+public:
+    static constexpr std::size_t size = sizeof...(Paths);
+    static constexpr std::array<std::string_view, size> paths{ Paths.view()... };
+
+    // Index of path, or size when it is not part of the schema: one hash, one displacement, one compare.
+    static constexpr std::size_t find(std::string_view path)
+    {
+        if constexpr (size == 0) {
+            return 0;
+        }
+        else {
+            auto const seed = hash_table.seeds[schemaHash(path, 0) % size];
+            auto const key = hash_table.keys[schemaHash(path, seed) % size];
+            return paths[key] == path ? key : size;
+        }
+    }
+    template <FixedString Path>
+    static consteval std::size_t index()
+    {
+        constexpr auto i = find(Path.view());
+        static_assert(i != size, "Path is not part of this schema");
+        return i;
+    }
+    static constexpr SchemaPath path(std::size_t i)
+    {
+        return parseSchemaPath(paths[i]);
+    }
+private:
+    struct HashTable
+    {
+        // Per bucket: the seed that places its keys.
+        std::array<std::uint32_t, size> seeds{};
+        // Per slot: the index of the key stored there.
+        std::array<std::size_t, size> keys{};
+    };
+    static consteval HashTable build()
+    {
+        HashTable table;
+        for (auto const p : paths)
+            (void)parseSchemaPath(p); // malformed paths fail here, at compile time
+        for (std::size_t i = 0 ; i < size ; i++) {
+            for (std::size_t j = i + 1 ; j < size ; j++) {
+                if (paths[i] == paths[j])
+                    throw std::invalid_argument("Duplicate path in schema");
+            }
+        }
+        std::array<std::size_t, size> bucket_of{};
+        std::array<std::size_t, size> bucket_size{};
+        for (std::size_t i = 0 ; i < size ; i++) {
+            bucket_of[i] = schemaHash(paths[i], 0) % size;
+            bucket_size[bucket_of[i]]++;
+        }
+        // Place the largest buckets first, while most slots are still free.
+        std::array<std::size_t, size> order{};
+        for (std::size_t b = 0 ; b < size ; b++)
+            order[b] = b;
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return bucket_size[a] > bucket_size[b]; });
+        std::array<bool, size> used{};
+        for (auto const bucket : order) {
+            if (bucket_size[bucket] == 0)
+                break;
+            for (std::uint32_t seed = 1 ; ; seed++) {
+                auto taken = used;
+                bool ok = true;
+                for (std::size_t i = 0 ; ok && i < size ; i++) {
+                    if (bucket_of[i] != bucket)
+                        continue;
+                    auto const slot = schemaHash(paths[i], seed) % size;
+                    ok = !taken[slot];
+                    taken[slot] = true;
+                }
+                if (!ok)
+                    continue;
+                for (std::size_t i = 0 ; i < size ; i++) {
+                    if (bucket_of[i] == bucket)
+                        table.keys[schemaHash(paths[i], seed) % size] = i;
+                }
+                table.seeds[bucket] = seed;
+                used = taken;
+                break;
+            }
+        }
+        return table;
+    }
+    static constexpr HashTable hash_table = build();
+};
+
+// The values of every Schema path in a frozen table, resolved once up front: get<"group sub.key">() is
+// a single array index, and get(path) at run time costs one perfect-hash probe.
+template <typename Schema>
+class SchemaTable final
+{
+public:
+    explicit SchemaTable(FrozenConfigTable table) : table(std::move(table))
+    {
+        for (std::size_t i = 0 ; i < Schema::size ; i++) {
+            auto const path = Schema::path(i);
+            this->values[i] = this->table.resolve(path.group, path.subsection, path.field);
+        }
+    }
+
+    template <FixedString Path>
+    FrozenFieldRef get() const
+    {
+        return this->values[Schema::template index<Path>()];
+    }
+    template <FixedString Path, typename T>
+    std::optional<T> getAs() const
+    {
+        return this->get<Path>().template getAs<T>();
+    }
+    // Null for paths outside the schema.
+    FrozenFieldRef get(std::string_view path) const
+    {
+        auto const i = Schema::find(path);
+        if (i == Schema::size)
+            return FrozenFieldRef{};
+        return this->values[i];
+    }
+    FrozenConfigTable const& frozen() const
+    {
+        return this->table;
+    }
+private:
+    FrozenConfigTable table;
+    std::array<FrozenFieldRef, Schema::size> values;
+};
+
+// Read-only view of a whole file: mmap'd where available, otherwise read into memory.
+class MappedFile final
+{
+public:
+    explicit MappedFile(std::filesystem::path const& filename)
+    {
+#if ACFP_HAS_MMAP
+        int const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::filesystem::filesystem_error("Could not open config file", filename, std::error_code{ errno, std::system_category() });
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            auto const ec = std::error_code{ errno, std::system_category() };
+            ::close(fd);
+            throw std::filesystem::filesystem_error("Could not stat config file", filename, ec);
+        }
+        if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+            // FIFOs, /proc files and the like report no (or a meaningless) size: read them instead.
+            this->readAll(fd, filename);
+            ::close(fd);
+            return;
+        }
+        void* const addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            auto const ec = std::error_code{ errno, std::system_category() };
+            ::close(fd);
+            throw std::filesystem::filesystem_error("Could not map config file", filename, ec);
+        }
+        ::close(fd);
+        this->data = static_cast<char const*>(addr);
+        this->size = static_cast<std::size_t>(st.st_size);
+        ::madvise(addr, this->size, MADV_SEQUENTIAL);
+#else
+        std::ifstream ifs;
+        ifs.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+        ifs.open(filename, std::ios_base::binary);
+        this->contents.assign(std::istreambuf_iterator<char>{ ifs }, std::istreambuf_iterator<char>{});
+        this->data = this->contents.data();
+        this->size = this->contents.size();
+#endif
+    }
+    ~MappedFile()
+    {
+#if ACFP_HAS_MMAP
+        if (this->data != nullptr && this->data != this->contents.data())
+            ::munmap(const_cast<char*>(this->data), this->size);
+#endif
+    }
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    std::string_view view() const
+    {
+        return std::string_view{ this->data, this->size };
+    }
+private:
+#if ACFP_HAS_MMAP
+    void readAll(int fd, std::filesystem::path const& filename)
+    {
+        char chunk[64 * 1024];
+        for (;;) {
+            auto const n = ::read(fd, chunk, sizeof(chunk));
+            if (n == 0)
+                break;
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                auto const ec = std::error_code{ errno, std::system_category() };
+                ::close(fd);
+                throw std::filesystem::filesystem_error("Could not read config file", filename, ec);
+            }
+            this->contents.append(chunk, static_cast<std::size_t>(n));
+        }
+        this->data = this->contents.data();
+        this->size = this->contents.size();
+    }
+#endif
+
+    char const* data = nullptr;
+    std::size_t size = 0;
+    // The file's bytes, when they were read rather than mapped.
+    std::string contents;
+};
+
+// On-disk form of a FrozenConfigTable: this header followed by the frozen image, in native byte order.
+struct ConfigImageHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    // config_image_byte_order as written; anything else means the image came from a foreign-endian host.
+    std::uint32_t byte_order;
+    std::uint64_t payload_size;
+    // fnv1a64 of the payload.
+    std::uint64_t checksum;
+};
+inline constexpr char config_image_magic[8] = { 'A', 'C', 'F', 'P', 'I', 'M', 'G', '\0' };
+inline constexpr std::uint32_t config_image_version = 1;
+inline constexpr std::uint32_t config_image_byte_order = 0x01020304;
+
+inline
+ConfigImageHeader makeConfigImageHeader(std::span<std::byte const> payload)
+{
+    ConfigImageHeader header{};
+    std::memcpy(header.magic, config_image_magic, sizeof(header.magic));
+    header.version = config_image_version;
+    header.byte_order = config_image_byte_order;
+    header.payload_size = payload.size();
+    header.checksum = fnv1a64(payload);
+    return header;
+}
+inline
+std::vector<std::byte> serialize(FrozenConfigTable const& frozen)
+{
+    auto const payload = frozen.image();
+    auto const header = makeConfigImageHeader(payload);
+    std::vector<std::byte> out(sizeof(header) + payload.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (!payload.empty())
+        std::memcpy(out.data() + sizeof(header), payload.data(), payload.size());
+    return out;
+}
+// Versioned, checksummed binary image of a table, loadable with loadConfigImage.
+inline
+std::vector<std::byte> serialize(ConfigTable const& ct)
+{
+    return serialize(FrozenConfigTable{ ct });
+}
+inline
+void saveConfigImage(std::filesystem::path const& filename, ConfigTable const& ct)
+{
+    auto const bytes = serialize(ct);
+    std::ofstream ofs;
+    ofs.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+    ofs.open(filename, std::ios_base::binary | std::ios_base::trunc);
+    ofs.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+struct ImageLoadOptions
+{
+    // Check the payload checksum and every record's bounds: O(image size).  Without it, loading only
+    // checks the header and is O(1); use it only for images from a trusted source.
+    bool verify = true;
+};
+
+// Serves a serialized image in place; owner keeps bytes alive.
+inline
+FrozenConfigTable loadConfigImage(std::span<std::byte const> bytes, std::shared_ptr<void const> owner, ImageLoadOptions const& options = {})
+{
+    ConfigImageHeader header;
+    if (bytes.size() < sizeof(header))
+        throw ConfigImageException("Config image truncated");
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, config_image_magic, sizeof(header.magic)) != 0)
+        throw ConfigImageException("Not a config image");
+    if (header.version != config_image_version)
+        throw ConfigImageException(std::format("Unsupported config image version {}", header.version));
+    if (header.byte_order != config_image_byte_order)
+        throw ConfigImageException("Config image has foreign byte order");
+    if (header.payload_size != bytes.size() - sizeof(header))
+        throw ConfigImageException("Config image size does not match its header");
+    auto const payload = bytes.subspan(sizeof(header));
+    if (options.verify) {
+        if (fnv1a64(payload) != header.checksum)
+            throw ConfigImageException("Config image checksum mismatch");
+        validateFrozenImage(payload);
+    }
+    return FrozenConfigTable{ payload, std::move(owner) };
+}
+// Maps the image file and serves lookups directly out of the mapping; nothing is parsed or copied.
+inline
+FrozenConfigTable loadConfigImage(std::filesystem::path const& filename, ImageLoadOptions const& options = {})
+{
+    auto file = std::make_shared<MappedFile const>(filename);
+    auto const view = file->view();
+    return loadConfigImage(std::as_bytes(std::span{ view.data(), view.size() }), std::move(file), options);
+}
+
+#if ACFP_HAS_MMAP
+// Owns one mapping of a shared-memory segment.
+class SharedMemoryMapping final
+{
+public:
+    SharedMemoryMapping(int fd, std::size_t size, bool writable)
+        : size(size)
+    {
+        void* const addr = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+            throw std::system_error(errno, std::system_category(), "Could not map shared config segment");
+        this->addr = addr;
+    }
+    ~SharedMemoryMapping()
+    {
+        ::munmap(this->addr, this->size);
+    }
+    SharedMemoryMapping(SharedMemoryMapping const&) = delete;
+    SharedMemoryMapping& operator=(SharedMemoryMapping const&) = delete;
+
+    void* data() const
+    {
+        return this->addr;
+    }
+    std::span<std::byte const> bytes() const
+    {
+        return std::span{ static_cast<std::byte const*>(this->addr), this->size };
+    }
+private:
+    void* addr = nullptr;
+    std::size_t size = 0;
+};
+
+// Control segment at the published name.  Each generation's image lives in its own segment
+// "<name>.<generation>", so readers never see a half-written image, and a retired segment stays valid
+// for readers that still map it after the publisher unlinks it.
+struct SharedConfigControl
+{
+    char magic[8];
+    // 0 until the first publish.
+    std::atomic<std::uint64_t> generation;
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared config generation must be address-free");
+inline constexpr char shared_config_magic[8] = { 'A', 'C', 'F', 'P', 'S', 'H', 'M', '\0' };
+
+inline
+std::string sharedConfigSegmentName(std::string_view name, std::uint64_t generation)
+{
+    return std::format("{}.{}", name, generation);
+}
+
+// Publishes tables into POSIX shared memory for SharedConfigReaders on the same host.
+// name follows shm_open rules: a leading '/' and no other slashes.  The control segment and the latest
+// image outlive the publisher, so a restarted publisher carries on the same generation sequence and
+// attached readers see its tables; remove() deletes them once the name is retired.
+class SharedConfigPublisher final
+{
+public:
+    explicit SharedConfigPublisher(std::string name)
+        : name(std::move(name))
+    {
+        int const fd = ::shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), std::format("Could not open shared config '{}'", this->name));
+        if (::ftruncate(fd, sizeof(SharedConfigControl)) != 0) {
+            auto const err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::system_category(), std::format("Could not size shared config '{}'", this->name));
+        }
+        try {
+            this->mapping = std::make_unique<SharedMemoryMapping>(fd, sizeof(SharedConfigControl), true);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        // Pick up where a previous publisher of the same name left off, so readers see the generation move forward.
+        this->control = static_cast<SharedConfigControl*>(this->mapping->data());
+        if (std::memcmp(this->control->magic, shared_config_magic, sizeof(shared_config_magic)) != 0) {
+            std::construct_at(&this->control->generation, 0);
+            std::memcpy(this->control->magic, shared_config_magic, sizeof(shared_config_magic));
+        }
+    }
+    SharedConfigPublisher(SharedConfigPublisher const&) = delete;
+    SharedConfigPublisher& operator=(SharedConfigPublisher const&) = delete;
+
+    void publish(ConfigTable const& ct)
+    {
+        this->publish(FrozenConfigTable{ ct });
+    }
+    void publish(FrozenConfigTable const& frozen)
+    {
+        auto const previous = this->control->generation.load(std::memory_order_relaxed);
+        auto const next = previous + 1;
+        auto const segment = sharedConfigSegmentName(this->name, next);
+        auto const payload = frozen.image();
+        auto const header = makeConfigImageHeader(payload);
+        auto const size = sizeof(header) + payload.size();
+
+        ::shm_unlink(segment.c_str()); // left over from a publisher that died mid-publish
+        int const fd = ::shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), std::format("Could not create shared config segment '{}'", segment));
+        try {
+            if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+                throw std::system_error(errno, std::system_category(), std::format("Could not size shared config segment '{}'", segment));
+            SharedMemoryMapping const out{ fd, size, true };
+            auto* const dst = static_cast<std::byte*>(out.data());
+            std::memcpy(dst, &header, sizeof(header));
+            if (!payload.empty())
+                std::memcpy(dst + sizeof(header), payload.data(), payload.size());
+        } catch (...) {
+            ::close(fd);
+            ::shm_unlink(segment.c_str());
+            throw;
+        }
+        ::close(fd);
+        this->control->generation.store(next, std::memory_order_release);
+        if (previous != 0)
+            ::shm_unlink(sharedConfigSegmentName(this->name, previous).c_str());
+    }
+    std::uint64_t generation() const
+    {
+        return this->control->generation.load(std::memory_order_relaxed);
+    }
+    // Unlinks the control segment and the latest image of name; readers already attached keep their
+    // current mapping, but no longer see new tables.
+    static void remove(std::string const& name)
+    {
+        int const fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd >= 0) {
+            try {
+                SharedMemoryMapping const mapping{ fd, sizeof(SharedConfigControl), false };
+                auto const* control = static_cast<SharedConfigControl const*>(mapping.data());
+                if (std::memcmp(control->magic, shared_config_magic, sizeof(shared_config_magic)) == 0) {
+                    if (auto const gen = control->generation.load(std::memory_order_acquire); gen != 0)
+                        ::shm_unlink(sharedConfigSegmentName(name, gen).c_str());
+                }
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+            ::close(fd);
+        }
+        ::shm_unlink(name.c_str());
+    }
+private:
+    std::string name;
+    std::unique_ptr<SharedMemoryMapping> mapping;
+    SharedConfigControl* control = nullptr;
+};
+
+// Read-only attachment to a SharedConfigPublisher's table.  Lookups go straight to the shared mapping;
+// call refresh() (e.g. once per request or on a timer) to pick up a republished table.
+// Not thread-safe; tables returned by table() keep their generation mapped and stay valid after a refresh.
+class SharedConfigReader final
+{
+public:
+    explicit SharedConfigReader(std::string name, ImageLoadOptions const& options = {})
+        : name(std::move(name))
+        , options(options)
+    {
+        int const fd = ::shm_open(this->name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), std::format("Could not open shared config '{}'", this->name));
+        try {
+            this->mapping = std::make_unique<SharedMemoryMapping>(fd, sizeof(SharedConfigControl), false);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        this->control = static_cast<SharedConfigControl const*>(this->mapping->data());
+        if (std::memcmp(this->control->magic, shared_config_magic, sizeof(shared_config_magic)) != 0)
+            throw ConfigImageException(std::format("'{}' is not a shared config", this->name));
+        this->refresh();
+    }
+
+    // True when a newer generation has been published than the one currently mapped.
+    bool stale() const
+    {
+        return this->control->generation.load(std::memory_order_acquire) != this->mapped_generation;
+    }
+    // Remaps if the publisher has moved on; returns whether the table changed.
+    bool refresh()
+    {
+        for (;;) {
+            auto const gen = this->control->generation.load(std::memory_order_acquire);
+            if (gen == this->mapped_generation)
+                return false;
+            auto const segment = sharedConfigSegmentName(this->name, gen);
+            int const fd = ::shm_open(segment.c_str(), O_RDONLY | O_CLOEXEC, 0);
+            if (fd < 0) {
+                // Retired between reading the generation and opening it; a newer one is already published.
+                if (errno == ENOENT && this->control->generation.load(std::memory_order_acquire) != gen)
+                    continue;
+                throw std::system_error(errno, std::system_category(), std::format("Could not open shared config segment '{}'", segment));
+            }
+            std::shared_ptr<SharedMemoryMapping const> image;
+            try {
+                struct stat st;
+                if (::fstat(fd, &st) != 0)
+                    throw std::system_error(errno, std::system_category(), std::format("Could not stat shared config segment '{}'", segment));
+                image = std::make_shared<SharedMemoryMapping const>(fd, static_cast<std::size_t>(st.st_size), false);
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+            ::close(fd);
+            auto const bytes = image->bytes();
+            this->current = loadConfigImage(bytes, std::move(image), this->options);
+            this->mapped_generation = gen;
+            return true;
+        }
+    }
+
+    FrozenConfigTable table() const
+    {
+        return this->current;
+    }
+    std::uint64_t generation() const
+    {
+        return this->mapped_generation;
+    }
+private:
+    std::string name;
+    ImageLoadOptions options;
+    std::unique_ptr<SharedMemoryMapping> mapping;
+    SharedConfigControl const* control = nullptr;
+    std::uint64_t mapped_generation = 0;
+    FrozenConfigTable current;
+};
+#endif
+
+// Which sections a parse keeps (ParseOptions::sections).  An empty filter keeps everything.
+class SectionFilter final
+{
+public:
+    // Keep every subsection of group name.
+    SectionFilter& group(std::string_view name)
+    {
+        this->groups[std::string{ name }].all = true;
+        return *this;
+    }
+    // Keep subsection subname of group name.
+    SectionFilter& section(std::string_view name, std::string_view subname)
+    {
+        this->groups[std::string{ name }].subsections.emplace_back(subname);
+        return *this;
+    }
+
+    bool empty() const
+    {
+        return this->groups.empty();
+    }
+    bool matches(std::string_view name, std::string_view subname) const
+    {
+        if (this->groups.empty())
+            return true;
+        auto const it = this->groups.find(name);
+        if (it == this->groups.end())
+            return false;
+        return it->second.all || std::ranges::find(it->second.subsections, subname) != it->second.subsections.end();
+    }
+private:
+    struct Group
+    {
+        bool all = false;
+        std::vector<std::string> subsections;
+    };
+    std::unordered_map<std::string, Group, StringHash, StringEqual> groups;
+};
+
+// One problem found by a parse that collects errors instead of throwing (ParseOptions::diagnostics).
+struct ParseDiagnostic
+{
+    enum class Kind : std::uint8_t
+    {
+        // Neither a "key = value" pair nor a section header.
+        MalformedLine,
+        // A key or value opens a quote that the line does not close.
+        UnterminatedQuote,
+        // A section header misses its ']' or leaves a name's quote open; its fields are dropped.
+        MalformedSectionHeader,
+    };
+    std::uint32_t line;
+    // 1-based byte column where the problem starts.
+    std::uint32_t column;
+    Kind kind;
+
+    std::string message() const
+    {
+        auto const what = this->kind == Kind::MalformedLine ? "expected 'key = value' or '[section]'"
+                        : this->kind == Kind::UnterminatedQuote ? "unterminated quoted string"
+                        : "malformed section header";
+        return std::format("line {}, column {}: {}", this->line, this->column, what);
+    }
+};
+
+struct ParseOptions
+{
+    // parseConfigFile(path) only: map the file and parse over the mapped bytes instead of going through std::ifstream.
+    bool memory_map = false;
+    // Store keys and values as views into the input instead of copies.
+    // parseConfigBuffer: the caller guarantees the buffer outlives the table.
+    // parseConfigFile(path): the table keeps the file contents alive.
+    bool zero_copy = false;
+    // Build the table on its own arena (see ConfigTable::Arena).
+    bool use_arena = false;
+    // parseConfigBuffer / parseConfigFile(path) with memory_map or zero_copy: tokenize with the vectorized
+    // line scanner (see scanLines) rather than line by line.
+    bool vectorized_scan = true;
+    // parseConfigBuffer / parseConfigFile(path) with memory_map or zero_copy: split the input at section
+    // header lines and parse the pieces on this many threads (0: std::thread::hardware_concurrency()).
+    // Inputs too small to be worth splitting are parsed on the calling thread.
+    unsigned threads = 1;
+    // Only build these sections.  Lines of other sections are skipped by a scan for the next header
+    // line, without being tokenized, so errors inside them go unreported.
+    SectionFilter sections{};
+    // parseConfigFile / parseConfigBuffer: instead of throwing at the first malformed line, append a
+    // ParseDiagnostic for each one, skip it and carry on; the table holds everything that did parse.
+    std::vector<ParseDiagnostic>* diagnostics = nullptr;
+    // parseConfigFile(path) only: honour 'include "path"' lines (see loadConfigWithIncludes).  Such files
+    // always parse through a mapping, and diagnostics does not apply to them.
+    bool includes = false;
+};
+
+inline
+void trimStringViewEnds(std::string_view& sv, std::string_view const trim_chars = std::string_view{ " \t" })
+{
+    auto fnos = sv.find_first_not_of(trim_chars);
+    if (fnos != std::string_view::npos)
+        sv.remove_prefix(fnos);
+    auto lnos = sv.find_last_not_of(trim_chars);
+    if (lnos != std::string_view::npos)
+        sv.remove_suffix(sv.size() - (lnos + 1));
+}
+// Position of the first character outside a quoted string, and not escaped, for which pred is true.
+template <typename Pred>
+inline
+std::size_t findFirstNotQuotedIf(std::string_view sv, Pred pred)
+{
+    bool quoted = false;
+    bool escaped = false;
+
+    for (std::size_t p = 0 ; p < sv.size() ; p++) {
+        if (sv[p] == '\\') {
+            escaped = !escaped;
+            continue;
+        }
+        if (sv[p] == '"') {
+            if (!escaped)
+                quoted = !quoted;
+        }
+        else if (pred(sv[p])) {
+            if (!escaped && !quoted)
+                return p;
+        }
+        // A backslash escapes only the character right after it.
+        escaped = false;
+    }
+    return std::string_view::npos;
+}
+inline
+std::size_t findFirstNotQuoted(std::string_view sv, char ch)
+{
+    return findFirstNotQuotedIf(sv, [ch](char c) { return c == ch; });
+}
+
+// Cuts a '#' or "//" comment off the line.  Only the first unquoted '#' or '/' counts, so a URL in a
+// quoted value ("http://host/") is not a comment.
+inline
+void trimStringComment(std::string_view& sv)
+{
+    auto p = findFirstNotQuotedIf(sv, [](char c) { return c == '#' || c == '/'; });
+    if (p != std::string_view::npos) {
+        if (sv[p] == '#')
+            sv.remove_suffix(sv.size() - p);
+        else if (sv[p] == '/' && sv.size() > p + 1 && sv[p+1] == '/') {
+            sv.remove_suffix(sv.size() - p);
+        }
+    }
+}
+// Strips a surrounding front/back pair.  Returns false, leaving sv as is, when front has no matching back.
+inline
+bool tryTrimStringQuotes(std::string_view& sv, char front = '"', char back = '"')
+{
+    if (sv.empty() || sv.front() != front)
+        return true;
+    if (sv.size() < 2 || sv.back() != back)
+        return false;
+    sv = sv.substr(1, sv.size() - 2);
+    return true;
+}
+inline
+void trimStringQuotes(std::string_view& sv, uint32_t line_num, char front = '"', char back = '"')
+{
+    if (!tryTrimStringQuotes(sv, front, back))
+        throw ConfigFileParseException(std::format("Unfished quoted string on line {}: '{}'", line_num, sv.substr(1)));
+}
+inline
+std::size_t findEqPos(std::string_view line)
+{
+    return findFirstNotQuoted(line, '=');
+}
+
+// Splits a (trimmed, comment-free) "[group sub]" line into its group and subsection names.
+// On an unclosed bracket or quote, returns false with bad set to the text from the opening character on.
+inline
+bool tryParseSectionName(std::string_view line, std::pair<std::string_view, std::string_view>& names, std::string_view& bad)
+{
+    auto const unquote = [&](std::string_view& sv, char front, char back) {
+        if (tryTrimStringQuotes(sv, front, back))
+            return true;
+        bad = sv;
+        return false;
+    };
+    if (!unquote(line, '[', ']'))
+        return false;
+    auto const sep = findFirstNotQuoted(line, ' ');
+    if (sep == std::string_view::npos) {
+        // Singleton Section
+        names = { line, std::string_view{} };
+        return true;
+    }
+    auto section_name = line.substr(0, sep);
+    trimStringViewEnds(section_name);
+    auto section_subname = line.substr(sep + 1, std::string_view::npos);
+    trimStringViewEnds(section_subname);
+    if (!unquote(section_name, '"', '"') || !unquote(section_subname, '"', '"'))
+        return false;
+    names = { section_name, section_subname };
+    return true;
+}
+inline
+std::pair<std::string_view, std::string_view> parseSectionName(std::string_view line, uint32_t line_num)
+{
+    std::pair<std::string_view, std::string_view> names;
+    std::string_view bad;
+    if (!tryParseSectionName(line, names, bad))
+        throw ConfigFileParseException(std::format("Unfished quoted string on line {}: '{}'", line_num, bad.substr(1)));
+    return names;
+}
+// Receives the parse as a stream of events, in input order.  Names, keys and values are views with
+// surrounding whitespace and quotes removed; they point into the input buffer (or, for std::istream input,
+// into the current line, valid only for the duration of the call).  onSection may return bool: false skips
+// the section's lines up to the next header without tokenizing them.
+template <typename H>
+concept ConfigEventHandler = requires(H& handler, std::string_view sv, uint32_t line_num) {
+    handler.onSection(sv, sv);
+    handler.onField(sv, sv, line_num);
+};
+// A handler with onInclude(path, line_num) receives 'include "path"' lines (quotes removed); without one
+// they are malformed lines.
+template <typename H>
+concept HandlesIncludes = requires(H& handler, std::string_view sv, uint32_t line_num) {
+    handler.onInclude(sv, line_num);
+};
+// A handler with skippingSection() can say that it skips the lines before the first header, as it can for
+// any later section by returning false from onSection.
+template <typename H>
+inline
+bool skipsCurrentSection(H const& handler)
+{
+    if constexpr (requires { { handler.skippingSection() } -> std::convertible_to<bool>; })
+        return handler.skippingSection();
+    else
+        return false;
+}
+// A handler with onError(ParseDiagnostic const&) is told about malformed lines, which are then skipped;
+// without one, the parse throws ConfigFileParseException.
+template <typename H>
+concept CollectsParseErrors = requires(H& handler, ParseDiagnostic const& diagnostic) {
+    handler.onError(diagnostic);
+};
+
+// Wraps another handler to record errors into a vector, dropping the fields of malformed sections.
+template <ConfigEventHandler Inner>
+class DiagnosticCollector final
+{
+public:
+    DiagnosticCollector(Inner& inner, std::vector<ParseDiagnostic>& diagnostics) : inner(inner), diagnostics(diagnostics) {}
+
+    decltype(auto) onSection(std::string_view name, std::string_view subname)
+    {
+        this->in_bad_section = false;
+        return this->inner.onSection(name, subname);
+    }
+    bool skippingSection() const
+    {
+        return skipsCurrentSection(this->inner);
+    }
+    void onField(std::string_view key, std::string_view value, uint32_t line_num)
+    {
+        if (!this->in_bad_section)
+            this->inner.onField(key, value, line_num);
+    }
+    void onError(ParseDiagnostic const& diagnostic)
+    {
+        this->diagnostics.push_back(diagnostic);
+        if (diagnostic.kind == ParseDiagnostic::Kind::MalformedSectionHeader)
+            this->in_bad_section = true;
+    }
+private:
+    Inner& inner;
+    std::vector<ParseDiagnostic>& diagnostics;
+    bool in_bad_section = false;
+};
+
+// Passes the problem to handler.onError, or throws the exception a parse has always thrown for it.
+// raw is the whole line (for the column) and text the offending part (for the exception message).
+template <ConfigEventHandler Handler>
+inline
+void reportParseError(Handler& handler, ParseDiagnostic::Kind kind, std::string_view raw, std::string_view text, uint32_t line_num)
+{
+    if constexpr (CollectsParseErrors<Handler>) {
+        auto const column = static_cast<uint32_t>(text.data() - raw.data()) + 1;
+        handler.onError(ParseDiagnostic{ line_num, column, kind });
+    }
+    else {
+        if (kind == ParseDiagnostic::Kind::MalformedLine)
+            throw ConfigFileParseException(std::format("Malformed line on line {}: '{}'", line_num, text));
+        throw ConfigFileParseException(std::format("Unfished quoted string on line {}: '{}'", line_num, text.substr(1)));
+    }
+}
+
+// ConfigEventHandler that builds a ConfigTable; what parseConfigFile and friends run on.
+// Honours options.zero_copy and options.sections.
+class ConfigTableBuilder final
+{
+public:
+    explicit ConfigTableBuilder(ConfigTable& ct, ParseOptions const& options = {})
+        : ct(ct)
+        , zero_copy(options.zero_copy)
+        , filter(options.sections.empty() ? nullptr : &options.sections)
+    {
+        this->onSection("", "");
+    }
+    bool onSection(std::string_view name, std::string_view subname)
+    {
+        if (this->filter && !this->filter->matches(name, subname)) {
+            this->cur_section = nullptr;
+            return false;
+        }
+        this->cur_section = &this->ct.getSection(name).getSubsection(subname);
+        return true;
+    }
+    // Whether the current section is filtered out; before any header that is the ("", "") one.
+    bool skippingSection() const
+    {
+        return this->cur_section == nullptr;
+    }
+    void onField(std::string_view key, std::string_view value, uint32_t /*line_num*/)
+    {
+        if (this->cur_section == nullptr)
+            return;
+        if (this->zero_copy)
+            this->cur_section->setFieldBorrowed(key, value);
+        else
+            this->cur_section->setField(key, value);
+    }
+private:
+    ConfigTable& ct;
+    Section* cur_section = nullptr;
+    bool zero_copy;
+    SectionFilter const* filter;
+};
+
+// Returns false when the handler asks to skip the section.  raw: the untrimmed line, for diagnostics.
+template <ConfigEventHandler Handler>
+inline
+bool parseSectionHeader(Handler& handler, std::string_view line, std::string_view raw, uint32_t line_num)
+{
+    std::pair<std::string_view, std::string_view> names;
+    std::string_view bad;
+    if (!tryParseSectionName(line, names, bad)) {
+        reportParseError(handler, ParseDiagnostic::Kind::MalformedSectionHeader, raw, bad, line_num);
+        return true;
+    }
+    auto const [section_name, section_subname] = names;
+    if constexpr (std::is_same_v<decltype(handler.onSection(section_name, section_subname)), bool>) {
+        return handler.onSection(section_name, section_subname);
+    }
+    else {
+        handler.onSection(section_name, section_subname);
+        return true;
+    }
+}
+// The quoted path of an 'include "path"' line, if line is one.
+inline
+std::optional<std::string_view> parseIncludeDirective(std::string_view line)
+{
+    constexpr std::string_view keyword = "include";
+    if (!line.starts_with(keyword) || line.size() == keyword.size() || (line[keyword.size()] != ' ' && line[keyword.size()] != '\t'))
+        return std::nullopt;
+    auto path = line.substr(keyword.size());
+    trimStringViewEnds(path);
+    if (path.size() < 2 || path.front() != '"' || path.back() != '"')
+        return std::nullopt;
+    return path.substr(1, path.size() - 2);
+}
+template <ConfigEventHandler Handler>
+inline
+void parseKeyValue(Handler& handler, std::string_view line, std::string_view raw, std::size_t eq_pos, uint32_t line_num)
+{
+    if (eq_pos == std::string_view::npos) {
+        if constexpr (HandlesIncludes<Handler>) {
+            if (auto const path = parseIncludeDirective(line))
+                return handler.onInclude(*path, line_num);
+        }
+        return reportParseError(handler, ParseDiagnostic::Kind::MalformedLine, raw, line, line_num);
+    }
+    auto key = line.substr(0, eq_pos);
+    trimStringViewEnds(key);
+    if (!tryTrimStringQuotes(key))
+        return reportParseError(handler, ParseDiagnostic::Kind::UnterminatedQuote, raw, key, line_num);
+    auto value = line.substr(eq_pos + 1, std::string_view::npos);
+    trimStringViewEnds(value);
+    if (!tryTrimStringQuotes(value))
+        return reportParseError(handler, ParseDiagnostic::Kind::UnterminatedQuote, raw, value, line_num);
+    handler.onField(key, value, line_num);
+}
+// Returns false when the line was a header whose section the handler asked to skip.
+template <ConfigEventHandler Handler>
+inline
+bool parseConfigLine(Handler& handler, std::string_view line, uint32_t line_num)
+{
+    auto const raw = line;
+    // Trim Spaces from ends
+    trimStringViewEnds(line);
+    // Remove comments
+    trimStringComment(line);
+    // Skip empty lines
+    if (line.size() == 0)
+        return true;
+    // Figure out what kind of line this is
+    if (line.front() == '[')
+        return parseSectionHeader(handler, line, raw, line_num);
+    parseKeyValue(handler, line, raw, findEqPos(line), line_num);
+    return true;
+}
+inline
+bool isSectionHeaderLine(std::string_view line)
+{
+    auto const first = line.find_first_not_of(" \t");
+    return first != std::string_view::npos && line[first] == '[';
+}
+// Offset of the next line (buffer starting at a line start) whose first non-blank is '[', or buffer.size().
+// Only the '[' bytes are inspected, so skipping a section costs about a memchr over it.
+inline
+std::size_t findSectionHeaderLine(std::string_view buffer)
+{
+    for (auto pos = buffer.find('[') ; pos != std::string_view::npos ; pos = buffer.find('[', pos + 1)) {
+        auto const eol = buffer.rfind('\n', pos);
+        auto const line_start = eol == std::string_view::npos ? 0 : eol + 1;
+        if (buffer.find_first_not_of(" \t", line_start) == pos)
+            return line_start;
+    }
+    return buffer.size();
+}
+
+// One line of a buffer as classified by scanLines.  Offsets are relative to the start of text.
+struct ScannedLine
+{
+    std::string_view text;
+    // First '#' or '/', or npos.
+    std::size_t comment;
+    // First '=', or npos.  Only the unquoted '=' when quoted is false.
+    std::size_t eq;
+    // Whether the line contains '"' or '\\', which make comment/quote handling context dependent (such
+    // lines are re-parsed by parseConfigLine).
+    bool quoted;
+};
+
+// Bitmasks over a 64-byte block: bit i is set when byte i is of the given class.
+struct ScanMasks
+{
+    std::uint64_t newline;
+    std::uint64_t comment;
+    std::uint64_t eq;
+    std::uint64_t quote;
+};
+
+inline
+ScanMasks classifyBlockScalar(char const* p)
+{
+    ScanMasks m{};
+    for (unsigned i = 0 ; i < 64 ; i++) {
+        auto const bit = std::uint64_t{ 1 } << i;
+        switch (p[i]) {
+            case '\n': m.newline |= bit; break;
+            case '#':
+            case '/': m.comment |= bit; break;
+            case '=': m.eq |= bit; break;
+            case '"':
+            case '\\': m.quote |= bit; break;
+        }
+    }
+    return m;
+}
+
+#if ACFP_HAS_X86_SIMD
+inline
+ScanMasks classifyBlockSSE2(char const* p)
+{
+    ScanMasks m{};
+    for (unsigned i = 0 ; i < 64 ; i += 16) {
+        auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+        auto const is = [&v](char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); };
+        auto const bits = [](__m128i x) { return std::uint64_t{ static_cast<std::uint16_t>(_mm_movemask_epi8(x)) }; };
+        m.newline |= bits(is('\n')) << i;
+        m.comment |= bits(_mm_or_si128(is('#'), is('/'))) << i;
+        m.eq |= bits(is('=')) << i;
+        m.quote |= bits(_mm_or_si128(is('"'), is('\\'))) << i;
+    }
+    return m;
+}
+__attribute__((target("avx2")))
+inline
+ScanMasks classifyBlockAVX2(char const* p)
+{
+    ScanMasks m{};
+    for (unsigned i = 0 ; i < 64 ; i += 32) {
+        auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i));
+        auto const is = [&v](char c) __attribute__((target("avx2"))) { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); };
+        auto const bits = [](__m256i x) __attribute__((target("avx2"))) { return std::uint64_t{ static_cast<std::uint32_t>(_mm256_movemask_epi8(x)) }; };
+        m.newline |= bits(is('\n')) << i;
+        m.comment |= bits(_mm256_or_si256(is('#'), is('/'))) << i;
+        m.eq |= bits(is('=')) << i;
+        m.quote |= bits(_mm256_or_si256(is('"'), is('\\'))) << i;
+    }
+    return m;
+}
+#endif
+
+// Walks the buffer 64 bytes at a time, classifying every byte with Classify, and calls on_line once per
+// '\n'-terminated line (plus a final unterminated one) in a single pass over the bytes.  If on_line
+// returns bool, false stops the scan after that line.  Returns the number of bytes consumed.
+template <typename Classify, typename F>
+inline
+std::size_t scanLinesWith(std::string_view buffer, Classify classify, F& on_line)
+{
+    constexpr auto npos = std::string_view::npos;
+    std::size_t line_start = 0;
+    std::size_t comment = npos;
+    std::size_t eq = npos;
+    bool quoted = false;
+    for (std::size_t base = 0 ; base < buffer.size() ; base += 64) {
+        ScanMasks m;
+        if (buffer.size() - base >= 64) {
+            m = classify(buffer.data() + base);
+        }
+        else {
+            // Zero padding matches no class.
+            char tail[64] = {};
+            std::memcpy(tail, buffer.data() + base, buffer.size() - base);
+            m = classify(tail);
+        }
+        for (auto bits = m.newline | m.comment | m.eq | m.quote ; bits != 0 ; bits &= bits - 1) {
+            auto const i = static_cast<unsigned>(std::countr_zero(bits));
+            auto const bit = std::uint64_t{ 1 } << i;
+            auto const pos = base + i;
+            if (m.newline & bit) {
+                ScannedLine const sl{ buffer.substr(line_start, pos - line_start), comment, eq, quoted };
+                if constexpr (std::is_same_v<std::invoke_result_t<F&, ScannedLine const&>, bool>) {
+                    if (!on_line(sl))
+                        return pos + 1;
+                }
+                else {
+                    on_line(sl);
+                }
+                line_start = pos + 1;
+                comment = npos;
+                eq = npos;
+                quoted = false;
+            }
+            else if (m.comment & bit) {
+                if (comment == npos)
+                    comment = pos - line_start;
+            }
+            else if (m.eq & bit) {
+                if (eq == npos)
+                    eq = pos - line_start;
+            }
+            else {
+                quoted = true;
+            }
+        }
+    }
+    if (line_start < buffer.size())
+        on_line(ScannedLine{ buffer.substr(line_start), comment, eq, quoted });
+    return buffer.size();
+}
+
+#if ACFP_HAS_X86_SIMD
+template <typename F>
+__attribute__((target("avx2"), flatten))
+inline
+std::size_t scanLinesAVX2(std::string_view buffer, F& on_line)
+{
+    return scanLinesWith(buffer, classifyBlockAVX2, on_line);
+}
+#endif
+
+enum class ScanIsa
+{
+    Scalar,
+    SSE2,
+    AVX2,
+};
+inline
+ScanIsa detectScanIsa()
+{
+#if ACFP_HAS_X86_SIMD
+    static ScanIsa const isa = __builtin_cpu_supports("avx2") ? ScanIsa::AVX2 : ScanIsa::SSE2;
+    return isa;
+#else
+    return ScanIsa::Scalar;
+#endif
+}
+
+template <typename F>
+inline
+std::size_t scanLines(std::string_view buffer, F&& on_line, ScanIsa isa = detectScanIsa())
+{
+#if ACFP_HAS_X86_SIMD
+    if (isa == ScanIsa::AVX2)
+        return scanLinesAVX2(buffer, on_line);
+    if (isa == ScanIsa::SSE2)
+        return scanLinesWith(buffer, classifyBlockSSE2, on_line);
+#endif
+    (void)isa;
+    return scanLinesWith(buffer, classifyBlockScalar, on_line);
+}
+
+// parseConfigLine for a line that scanLines has already classified: lines without quotes or escapes take
+// their comment and '=' positions from the scan instead of re-walking the bytes.
+template <ConfigEventHandler Handler>
+inline
+bool parseScannedLine(Handler& handler, ScannedLine const& sl, uint32_t line_num)
+{
+    if (sl.quoted)
+        return parseConfigLine(handler, sl.text, line_num);
+
+    auto line = sl.text;
+    trimStringViewEnds(line);
+    auto const lead = static_cast<std::size_t>(line.data() - sl.text.data());
+    // Same rule as trimStringComment: only the first '#' or '/' counts, and a '/' only when doubled.
+    if (sl.comment != std::string_view::npos) {
+        auto const p = sl.comment - lead;
+        if (line[p] == '#' || (line.size() > p + 1 && line[p + 1] == '/'))
+            line.remove_suffix(line.size() - p);
+    }
+    if (line.size() == 0)
+        return true;
+    if (line.front() == '[')
+        return parseSectionHeader(handler, line, sl.text, line_num);
+    auto eq_pos = std::string_view::npos;
+    if (sl.eq != std::string_view::npos && sl.eq - lead < line.size())
+        eq_pos = sl.eq - lead;
+    parseKeyValue(handler, line, sl.text, eq_pos, line_num);
+    return true;
+}
+
+inline
+ConfigTable makeConfigTable(ParseOptions const& options)
+{
+    if (options.use_arena)
+        return ConfigTable{ ConfigTable::Arena{} };
+    return ConfigTable{};
+}
+
+// Event-driven parse of a stream: handler sees each section header and field as it is read, without a
+// ConfigTable being built.
+template <ConfigEventHandler Handler>
+inline
+void parseConfigEvents(std::istream& is, Handler& handler)
+{
+    std::string line_string;
+    bool skipping = skipsCurrentSection(handler);
+    for (uint32_t line_num = 1 ; std::getline(is, line_string) ; line_num++) {
+        if (skipping && !isSectionHeaderLine(line_string))
+            continue;
+        skipping = !parseConfigLine(handler, line_string, line_num);
+    }
+}
+// Event-driven parse of an in-memory buffer, numbering its lines from first_line.  The views handed to
+// handler point into buffer and stay valid as long as it does.  Honours options.vectorized_scan.
+template <ConfigEventHandler Handler>
+inline
+void parseConfigEvents(std::string_view buffer, Handler& handler, ParseOptions const& options = {}, uint32_t first_line = 1)
+{
+    uint32_t line_num = first_line;
+    auto const skipToHeader = [&] {
+        auto const next = findSectionHeaderLine(buffer);
+        line_num += static_cast<uint32_t>(std::count(buffer.begin(), buffer.begin() + next, '\n'));
+        buffer.remove_prefix(next);
+    };
+    if (skipsCurrentSection(handler))
+        skipToHeader();
+    while (!buffer.empty()) {
+        // Parse up to the header of a section the handler skips (or the end) ...
+        if (options.vectorized_scan) {
+            buffer.remove_prefix(scanLines(buffer, [&](ScannedLine const& sl) {
+                return parseScannedLine(handler, sl, line_num++);
+            }));
+        }
+        else {
+            for (bool parsing = true ; parsing && !buffer.empty() ; ) {
+                auto const eol = buffer.find('\n');
+                parsing = parseConfigLine(handler, buffer.substr(0, eol), line_num++);
+                buffer.remove_prefix(eol == std::string_view::npos ? buffer.size() : eol + 1);
+            }
+        }
+        // ... then jump to the next header.
+        skipToHeader();
+    }
+}
+
+inline
+ConfigTable parseConfigFile(std::istream& is, ParseOptions const& options = {})
+{
+    auto ct = makeConfigTable(options);
+    // Lines are read into a reused buffer, so they can never be borrowed.
+    auto line_options = options;
+    line_options.zero_copy = false;
+    ConfigTableBuilder builder{ ct, line_options };
+    if (options.diagnostics) {
+        DiagnosticCollector collector{ builder, *options.diagnostics };
+        parseConfigEvents(is, collector);
+    }
+    else {
+        parseConfigEvents(is, builder);
+    }
+    return ct;
+}
+// Parses buffer into ct, numbering its lines from first_line.  Errors go to diagnostics when non-null.
+inline
+void parseConfigInto(ConfigTable& ct, std::string_view buffer, uint32_t first_line, ParseOptions const& options, std::vector<ParseDiagnostic>* diagnostics)
+{
+    ConfigTableBuilder builder{ ct, options };
+    if (diagnostics) {
+        DiagnosticCollector collector{ builder, *diagnostics };
+        parseConfigEvents(buffer, collector, options, first_line);
+    }
+    else {
+        parseConfigEvents(buffer, builder, options, first_line);
+    }
+}
+inline
+void parseConfigInto(ConfigTable& ct, std::string_view buffer, uint32_t first_line, ParseOptions const& options)
+{
+    parseConfigInto(ct, buffer, first_line, options, options.diagnostics);
+}
+
+// Splits buffer into roughly chunk_count pieces for parallel parsing.  Every piece after the first starts
+// on a section header line, so it parses the same on its own as it would in sequence.
+inline
+std::vector<std::string_view> splitAtSectionHeaders(std::string_view buffer, std::size_t chunk_count)
+{
+    std::vector<std::string_view> chunks;
+    auto const target = buffer.size() / std::max<std::size_t>(chunk_count, 1);
+    std::size_t start = 0;
+    while (start < buffer.size()) {
+        auto pos = std::min(start + std::max<std::size_t>(target, 1), buffer.size());
+        // Advance to the next line starting (after spaces/tabs) with '['.
+        std::size_t next = buffer.size();
+        while (pos < buffer.size()) {
+            auto const eol = buffer.find('\n', pos == 0 ? 0 : pos - 1);
+            if (eol == std::string_view::npos)
+                break;
+            auto const line_start = eol + 1;
+            auto const first = buffer.find_first_not_of(" \t", line_start);
+            if (first != std::string_view::npos && buffer[first] == '[') {
+                next = line_start;
+                break;
+            }
+            pos = line_start + 1;
+        }
+        chunks.push_back(buffer.substr(start, next - start));
+        start = next;
+    }
+    return chunks;
+}
+
+inline
+void parseConfigParallel(ConfigTable& ct, std::string_view buffer, unsigned threads, ParseOptions const& options)
+{
+    constexpr std::size_t min_chunk_size = 1024 * 1024;
+    auto const chunk_count = std::min<std::size_t>(std::size_t{ threads } * 4, buffer.size() / min_chunk_size);
+    if (threads <= 1 || chunk_count <= 1)
+        return parseConfigInto(ct, buffer, 1, options);
+
+    auto const chunks = splitAtSectionHeaders(buffer, chunk_count);
+    std::vector<uint32_t> first_lines;
+    uint32_t line_num = 1;
+    for (auto const& chunk : chunks) {
+        first_lines.push_back(line_num);
+        line_num += static_cast<uint32_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+    }
+
+    // Chunk 0 is parsed straight into ct; the rest into partial tables merged afterwards in order.
+    std::vector<ConfigTable> partials;
+    partials.reserve(chunks.size());
+    for (std::size_t i = 1 ; i < chunks.size() ; i++)
+        partials.push_back(makeConfigTable(options));
+    std::vector<std::exception_ptr> errors(chunks.size());
+    std::vector<std::vector<ParseDiagnostic>> diagnostics(options.diagnostics ? chunks.size() : 0);
+    std::atomic<std::size_t> next_chunk{ 0 };
+    {
+        std::vector<std::jthread> pool;
+        auto const worker = [&] {
+            for (auto i = next_chunk++ ; i < chunks.size() ; i = next_chunk++) {
+                try {
+                    parseConfigInto(i == 0 ? ct : partials[i - 1], chunks[i], first_lines[i], options,
+                                    options.diagnostics ? &diagnostics[i] : nullptr);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+        for (unsigned t = 1 ; t < std::min<std::size_t>(threads, chunks.size()) ; t++)
+            pool.emplace_back(worker);
+        worker();
+    }
+    // The earliest failing chunk holds the error a sequential parse would have thrown.
+    for (auto const& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+    for (auto const& partial : partials)
+        ct.mergeShared(partial);
+    for (auto const& chunk_diagnostics : diagnostics)
+        options.diagnostics->insert(options.diagnostics->end(), chunk_diagnostics.begin(), chunk_diagnostics.end());
+}
+
+// Parses an in-memory buffer directly, without copying lines out of it.
+inline
+ConfigTable parseConfigBuffer(std::string_view buffer, ParseOptions const& options = {})
+{
+    auto ct = makeConfigTable(options);
+    auto const threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    parseConfigParallel(ct, buffer, threads, options);
+    return ct;
+}
+// A file's identity for caching: contents are assumed unchanged while (mtime, size) are.
+struct FileStamp
+{
+    std::filesystem::path path;
+    std::filesystem::file_time_type mtime;
+    std::uintmax_t size;
+
+    static FileStamp of(std::filesystem::path const& path)
+    {
+        return FileStamp{ path, std::filesystem::last_write_time(path), std::filesystem::file_size(path) };
+    }
+    bool current() const
+    {
+        std::error_code ec;
+        auto const mtime = std::filesystem::last_write_time(this->path, ec);
+        if (ec)
+            return false;
+        auto const size = std::filesystem::file_size(this->path, ec);
+        return !ec && mtime == this->mtime && size == this->size;
+    }
+};
+
+inline
+std::vector<std::filesystem::path> expandInclude(std::filesystem::path const& dir, std::string_view include);
+
+// The files a pattern include matched, so that a file added to (or removed from) the directory later
+// invalidates a cached parse.
+struct IncludeExpansion
+{
+    std::filesystem::path dir;
+    std::string include;
+    std::vector<std::filesystem::path> matches;
+
+    bool current() const
+    {
+        try {
+            return expandInclude(this->dir, this->include) == this->matches;
+        }
+        catch (std::filesystem::filesystem_error const&) {
+            return false;
+        }
+    }
+};
+
+// A file parsed with its includes resolved, and every file and pattern include that went into it.
+struct IncludedConfig
+{
+    std::shared_ptr<ConfigTable const> table;
+    std::vector<FileStamp> files;
+    std::vector<IncludeExpansion> patterns;
+};
+
+// Process-wide cache for loadConfigWithIncludes, keyed by canonical path.  An entry is reused while the
+// (mtime, size) of its file and of everything it includes are unchanged, and its pattern includes still
+// match the same files, so a file included by many top-level configs is parsed once.
+class IncludeCache final
+{
+public:
+    static IncludeCache& instance()
+    {
+        static IncludeCache cache;
+        return cache;
+    }
+    std::optional<IncludedConfig> find(std::string const& key) const
+    {
+        std::optional<IncludedConfig> entry;
+        {
+            std::lock_guard const lock{ this->mutex };
+            auto const it = this->entries.find(key);
+            if (it == this->entries.end())
+                return std::nullopt;
+            entry = it->second;
+        }
+        // Stat outside the lock.
+        if (!std::ranges::all_of(entry->files, &FileStamp::current) || !std::ranges::all_of(entry->patterns, &IncludeExpansion::current))
+            return std::nullopt;
+        return entry;
+    }
+    void store(std::string key, IncludedConfig entry)
+    {
+        std::lock_guard const lock{ this->mutex };
+        this->entries.insert_or_assign(std::move(key), std::move(entry));
+    }
+    void clear()
+    {
+        std::lock_guard const lock{ this->mutex };
+        this->entries.clear();
+    }
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, IncludedConfig> entries;
+};
+
+// Glob match of name against pattern, where '*' matches any run of characters and '?' any one.
+constexpr
+bool matchWildcard(std::string_view pattern, std::string_view name)
+{
+    std::size_t p = 0;
+    std::size_t n = 0;
+    auto star = std::string_view::npos;
+    std::size_t star_n = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        }
+        else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_n = n;
+        }
+        else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_n;
+        }
+        else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+        p++;
+    return p == pattern.size();
+}
+// Whether an include has '*' or '?' in its last component.
+inline
+bool isIncludePattern(std::string_view include)
+{
+    return std::filesystem::path{ include }.filename().string().find_first_of("*?") != std::string::npos;
+}
+// The files an include names, relative to dir: the path itself, or for a pattern (see isIncludePattern),
+// the matching regular files in sorted order.
+inline
+std::vector<std::filesystem::path> expandInclude(std::filesystem::path const& dir, std::string_view include)
+{
+    auto path = dir / std::filesystem::path{ include };
+    if (!isIncludePattern(include))
+        return { path };
+    auto const name = path.filename().string();
+    std::vector<std::filesystem::path> matches;
+    for (auto const& entry : std::filesystem::directory_iterator{ path.parent_path() }) {
+        if (entry.is_regular_file() && matchWildcard(name, entry.path().filename().string()))
+            matches.push_back(entry.path());
+    }
+    std::ranges::sort(matches);
+    return matches;
+}
+
+// Splits a file at its include lines: text pieces parse into their own tables, and the text after an
+// include continues in the section that was current before it.
+class IncludeSplitter final
+{
+public:
+    struct Piece
+    {
+        ConfigTable table;
+        // Non-empty for an include.
+        std::string include;
+        uint32_t line_num = 0;
+    };
+
+    explicit IncludeSplitter(ParseOptions const& options) : options(options)
+    {
+        this->startText();
+    }
+    bool onSection(std::string_view name, std::string_view subname)
+    {
+        this->group = name;
+        this->subsection = subname;
+        return this->builder->onSection(name, subname);
+    }
+    bool skippingSection() const
+    {
+        return this->builder->skippingSection();
+    }
+    void onField(std::string_view key, std::string_view value, uint32_t line_num)
+    {
+        this->builder->onField(key, value, line_num);
+    }
+    void onInclude(std::string_view path, uint32_t line_num)
+    {
+        this->pieces.push_back(Piece{ ConfigTable{}, std::string{ path }, line_num });
+        this->startText();
+        this->builder->onSection(this->group, this->subsection);
+    }
+
+    // A deque, so that builders' references to earlier pieces stay valid.
+    std::deque<Piece> pieces;
+private:
+    void startText()
+    {
+        auto& piece = this->pieces.emplace_back();
+        this->builder.emplace(piece.table, this->options);
+    }
+
+    ParseOptions const& options;
+    std::optional<ConfigTableBuilder> builder;
+    std::string group;
+    std::string subsection;
+};
+
+// Threads loadConfigWithIncludes runs beside its callers', counted across nested includes so that a wide
+// or deep include tree never runs more than std::thread::hardware_concurrency() of them at once.
+inline
+std::atomic<unsigned>& includeLoaderThreads()
+{
+    static std::atomic<unsigned> count{ 0 };
+    return count;
+}
+
+// Parses a file, replacing each 'include "path"' line with the contents of the named files: relative
+// paths are resolved against the including file's directory, and '*'/'?' in the last component include
+// every matching file in name order.  An included file parses on its own (lines before its first header go
+// to the ("", "") section) and is applied at the include line, so later lines of the including file
+// override it.  Includes are loaded concurrently (see includeLoaderThreads), results are cached in
+// IncludeCache, and a file that includes itself, directly or not, is an error.  chain: the files including
+// this one.
+inline
+IncludedConfig loadConfigWithIncludes(std::filesystem::path const& filename, ParseOptions const& options, std::vector<std::filesystem::path> chain = {})
+{
+    auto const path = std::filesystem::canonical(filename);
+    if (std::ranges::find(chain, path) != chain.end()) {
+        std::string cycle;
+        for (auto const& link : chain)
+            cycle += link.string() + " -> ";
+        throw ConfigFileParseException(std::format("Include cycle: {}{}", cycle, path.string()));
+    }
+    // Filtered parses depend on the filter, so only unfiltered ones are cached.
+    bool const cacheable = options.sections.empty();
+    auto const key = std::format("{}{}", options.zero_copy ? 'z' : 'c', path.string());
+    if (cacheable) {
+        if (auto cached = IncludeCache::instance().find(key))
+            return std::move(*cached);
+    }
+
+    IncludedConfig result;
+    result.files.push_back(FileStamp::of(path));
+    auto const file = std::make_shared<MappedFile const>(path);
+    auto file_options = options;
+    file_options.diagnostics = nullptr;
+    IncludeSplitter splitter{ file_options };
+    try {
+        parseConfigEvents(file->view(), splitter, file_options);
+    }
+    catch (ConfigFileParseException const& e) {
+        throw ConfigFileParseException(std::format("{}: {}", path.string(), e.what()));
+    }
+
+    // Load every included file concurrently, then apply everything in declaration order.
+    chain.push_back(path);
+    struct Job
+    {
+        std::size_t piece;
+        std::filesystem::path target;
+    };
+    std::vector<Job> jobs;
+    for (std::size_t i = 0 ; i < splitter.pieces.size() ; i++) {
+        auto const& piece = splitter.pieces[i];
+        if (piece.include.empty())
+            continue;
+        auto targets = expandInclude(path.parent_path(), piece.include);
+        for (auto const& target : targets)
+            jobs.push_back(Job{ i, target });
+        if (isIncludePattern(piece.include))
+            result.patterns.push_back(IncludeExpansion{ path.parent_path(), piece.include, std::move(targets) });
+    }
+    std::vector<IncludedConfig> loaded(jobs.size());
+    std::vector<std::exception_ptr> errors(jobs.size());
+    std::atomic<std::size_t> next_job{ 0 };
+    {
+        std::vector<std::jthread> pool;
+        auto const worker = [&] {
+            for (auto j = next_job++ ; j < jobs.size() ; j = next_job++) {
+                try {
+                    loaded[j] = loadConfigWithIncludes(jobs[j].target, file_options, chain);
+                }
+                catch (...) {
+                    errors[j] = std::current_exception();
+                }
+            }
+        };
+        // Helpers only while the process-wide budget allows; the calling thread always works too, so a
+        // nested load never waits for a thread that cannot start.
+        auto& running = includeLoaderThreads();
+        auto const limit = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t t = 1 ; t < jobs.size() ; t++) {
+            if (running.fetch_add(1) >= limit) {
+                running--;
+                break;
+            }
+            pool.emplace_back([&] {
+                worker();
+                running--;
+            });
+        }
+        worker();
+    }
+    // The first failing include in declaration order is the error a sequential load would have thrown.
+    for (auto const& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+    auto table = std::make_shared<ConfigTable>();
+    for (std::size_t i = 0, j = 0 ; i < splitter.pieces.size() ; i++) {
+        table->mergeShared(splitter.pieces[i].table);
+        for ( ; j < jobs.size() && jobs[j].piece == i ; j++) {
+            auto const& included = loaded[j];
+            table->mergeShared(*included.table);
+            result.files.insert(result.files.end(), included.files.begin(), included.files.end());
+            result.patterns.insert(result.patterns.end(), included.patterns.begin(), included.patterns.end());
+        }
+    }
+    if (options.zero_copy)
+        table->retainBuffer(file);
+    result.table = std::move(table);
+    if (cacheable)
+        IncludeCache::instance().store(key, result);
+    return result;
+}
+
+inline
+ConfigTable parseConfigFile(std::filesystem::path filename, ParseOptions const& options = {})
+{
+    if (options.includes) {
+        // A copy: the loaded table's sections are shared with IncludeCache, which may drop them at any time.
+        auto ct = makeConfigTable(options);
+        ct.merge(*loadConfigWithIncludes(filename, options).table);
+        return ct;
+    }
+    if (options.memory_map || options.zero_copy) {
+        auto const file = std::make_shared<MappedFile const>(filename);
+        auto ct = parseConfigBuffer(file->view(), options);
+        if (options.zero_copy)
+            ct.retainBuffer(file);
+        return ct;
+    }
+    std::ifstream ifs;
+    ifs.exceptions(std::ios_base::badbit);
+    ifs.open(filename);
+    return parseConfigFile(ifs, options);
+}
+
+struct InterpolationOptions
+{
+    // Expand ${env:NAME} from the process environment; otherwise such references are errors.
+    bool environment = true;
+};
+
+// Expands references inside values, lazily: "${group.key}" / "${group sub.key}" (the path syntax of
+// ConfigSchema) is replaced by that field, itself expanded, "${env:NAME}" by an environment variable and
+// "$$" by a literal '$'.  A field is expanded on its first lookup and memoised; values without a '$' are
+// returned straight from the table.  Unknown references and cycles throw ConfigInterpolationException.
+// The table must outlive the interpolator and not be modified while it is in use.  Thread-safe.
+class Interpolator final
+{
+public:
+    explicit Interpolator(ConfigTable const& table, InterpolationOptions const& options = {})
+        : table(table)
+        , options(options)
+    {}
+    // The interpolator keeps a reference to the table, so it cannot take a temporary.
+    Interpolator(ConfigTable&&, InterpolationOptions const& = {}) = delete;
+
+    std::optional<std::string_view> getField(std::string_view group, std::string_view subsection, std::string_view key) const
+    {
+        auto const value = this->table.resolve(group, subsection, key).get();
+        if (!value || value->find('$') == std::string_view::npos)
+            return value;
+        std::vector<std::string> in_progress;
+        return this->expandField(group, subsection, key, *value, in_progress);
+    }
+    template <typename T>
+    std::optional<T> getFieldAs(std::string_view group, std::string_view subsection, std::string_view key) const
+    {
+        return parse<T>(this->getField(group, subsection, key));
+    }
+    // A copy of the table with every reference expanded.  Sections without references stay shared (see
+    // ConfigTable::mergeShared).
+    ConfigTable expandAll() const
+    {
+        ConfigTable out;
+        out.mergeShared(this->table);
+        for (auto const& [group, sections] : this->table) {
+            for (auto const& [subsection, section] : sections) {
+                for (auto const& [key, value] : section) {
+                    if (value.find('$') != std::string_view::npos)
+                        out.getSection(group).getSubsection(subsection).setField(key, *this->getField(group, subsection, key));
+                }
+            }
+        }
+        return out;
+    }
+private:
+    static std::string displayPath(std::string_view group, std::string_view subsection, std::string_view key)
+    {
+        if (subsection.empty())
+            return std::format("{}.{}", group, key);
+        return std::format("{} {}.{}", group, subsection, key);
+    }
+    std::string_view expandField(std::string_view group, std::string_view subsection, std::string_view key, std::string_view value, std::vector<std::string>& in_progress) const
+    {
+        auto memo_key = std::string{ group };
+        memo_key += '\0';
+        memo_key += subsection;
+        memo_key += '\0';
+        memo_key += key;
+        {
+            std::lock_guard const lock{ this->mutex };
+            if (auto const it = this->memo.find(memo_key) ; it != this->memo.end())
+                return it->second;
+        }
+        auto const path = displayPath(group, subsection, key);
+        if (std::ranges::find(in_progress, path) != in_progress.end()) {
+            std::string cycle;
+            for (auto const& link : in_progress)
+                cycle += link + " -> ";
+            throw ConfigInterpolationException(std::format("Interpolation cycle: {}{}", cycle, path));
+        }
+        in_progress.push_back(path);
+        auto expanded = this->expand(value, in_progress);
+        in_progress.pop_back();
+        std::lock_guard const lock{ this->mutex };
+        // Node-based, so the returned view stays valid as the memo grows.
+        return this->memo.try_emplace(std::move(memo_key), std::move(expanded)).first->second;
+    }
+    std::string expand(std::string_view value, std::vector<std::string>& in_progress) const
+    {
+        std::string out;
+        for (std::size_t pos = 0 ; pos < value.size() ; ) {
+            auto const dollar = value.find('$', pos);
+            out += value.substr(pos, dollar - pos);
+            if (dollar == std::string_view::npos)
+                break;
+            if (dollar + 1 < value.size() && value[dollar + 1] == '$') {
+                out += '$';
+                pos = dollar + 2;
+                continue;
+            }
+            if (dollar + 1 >= value.size() || value[dollar + 1] != '{') {
+                out += '$';
+                pos = dollar + 1;
+                continue;
+            }
+            auto const close = value.find('}', dollar + 2);
+            if (close == std::string_view::npos)
+                throw ConfigInterpolationException(std::format("Unterminated reference in '{}'", value));
+            out += this->lookup(value.substr(dollar + 2, close - dollar - 2), in_progress);
+            pos = close + 1;
+        }
+        return out;
+    }
+    std::string_view lookup(std::string_view reference, std::vector<std::string>& in_progress) const
+    {
+        if (reference.starts_with("env:")) {
+            auto const name = std::string{ reference.substr(4) };
+            char const* const env = this->options.environment ? std::getenv(name.c_str()) : nullptr;
+            if (env == nullptr)
+                throw ConfigInterpolationException(std::format("Undefined environment variable '{}'", name));
+            return env;
+        }
+        SchemaPath path;
+        try {
+            path = parseSchemaPath(reference);
+        }
+        catch (std::invalid_argument const&) {
+            throw ConfigInterpolationException(std::format("Malformed reference '${{{}}}'", reference));
+        }
+        auto const value = this->table.resolve(path.group, path.subsection, path.field).get();
+        if (!value)
+            throw ConfigInterpolationException(std::format("Reference to undefined field '${{{}}}'", reference));
+        if (value->find('$') == std::string_view::npos)
+            return *value;
+        return this->expandField(path.group, path.subsection, path.field, *value, in_progress);
+    }
+
+    ConfigTable const& table;
+    InterpolationOptions options;
+    mutable std::mutex mutex;
+    mutable std::unordered_map<std::string, std::string> memo;
+};
+
+// freeze with every reference expanded up front, so the frozen table serves final values.
+inline
+FrozenConfigTable freeze(ConfigTable const& ct, InterpolationOptions const& options)
+{
+    return FrozenConfigTable{ Interpolator{ ct, options }.expandAll() };
+}
+
+// One subsection as seen through a ConfigOverlay: each lookup takes the first layer, from the top, that
+// has the field.
+class OverlaySection final
+{
+public:
+    // layers: highest precedence first.
+    explicit OverlaySection(std::vector<Section const*> layers) : layers(std::move(layers)) {}
+
+    bool hasField(std::string_view key) const
+    {
+        return std::ranges::any_of(this->layers, [&](Section const* section) { return section->hasField(key); });
+    }
+    std::optional<std::string_view> getField(std::string_view key) const
+    {
+        return this->resolveField(key).get();
+    }
+    template <typename T>
+    std::optional<T> getFieldAs(std::string_view key) const
+    {
+        return parse<T>(this->getField(key));
+    }
+    FieldRef resolveField(std::string_view key) const
+    {
+        for (auto const* section : this->layers) {
+            if (auto ref = section->resolveField(key))
+                return ref;
+        }
+        return FieldRef{};
+    }
+    std::optional<std::string_view> operator[](std::string_view key) const
+    {
+        return this->getField(key);
+    }
+    // Calls f(key, value) once per effective field, in unspecified order.
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (std::size_t i = 0 ; i < this->layers.size() ; i++) {
+            this->layers[i]->forEach([&](std::string_view key, std::string_view value) {
+                bool const shadowed = std::any_of(this->layers.begin(), this->layers.begin() + i, [&](Section const* above) { return above->hasField(key); });
+                if (!shadowed)
+                    f(key, value);
+            });
+        }
+    }
+    bool empty() const
+    {
+        return std::ranges::all_of(this->layers, &Section::empty);
+    }
+private:
+    std::vector<Section const*> layers;
+};
+
+// Read-only stack of tables, e.g. defaults, site file, host file, command line: lookups walk the layers
+// from the last added down, so later layers override earlier ones field by field, and no layer is copied.
+// flatten() collapses the stack into one table when lookups through the layers become the bottleneck.
+class ConfigOverlay final
+{
+public:
+    ConfigOverlay() = default;
+
+    // The caller keeps table alive (and unmodified) for the lifetime of the overlay.
+    ConfigOverlay& addLayer(ConfigTable const& table)
+    {
+        this->layers.push_back(&table);
+        return *this;
+    }
+    // A temporary would dangle; pass a shared_ptr to hand the overlay ownership.
+    ConfigOverlay& addLayer(ConfigTable&&) = delete;
+    ConfigOverlay& addLayer(std::shared_ptr<ConfigTable const> table)
+    {
+        this->layers.push_back(table.get());
+        this->owned.push_back(std::move(table));
+        return *this;
+    }
+    std::size_t layerCount() const
+    {
+        return this->layers.size();
+    }
+
+    bool hasSection(std::string_view key) const
+    {
+        return std::ranges::any_of(this->layers, [&](ConfigTable const* table) { return table->hasSection(key); });
+    }
+    bool hasSubsection(std::string_view key, std::string_view subkey) const
+    {
+        return std::ranges::any_of(this->layers, [&](ConfigTable const* table) { return (*table)[key].hasSubsection(subkey); });
+    }
+    // The subsection as merged across layers.
+    OverlaySection getSubsection(std::string_view key, std::string_view subkey) const
+    {
+        std::vector<Section const*> sections;
+        for (auto it = this->layers.rbegin() ; it != this->layers.rend() ; ++it) {
+            auto const& group = (**it)[key];
+            if (group.hasSubsection(subkey))
+                sections.push_back(&group[subkey]);
+        }
+        return OverlaySection{ std::move(sections) };
+    }
+    FieldRef resolve(std::string_view key, std::string_view subkey, std::string_view field) const
+    {
+        for (auto it = this->layers.rbegin() ; it != this->layers.rend() ; ++it) {
+            if (auto ref = (*it)->resolve(key, subkey, field))
+                return ref;
+        }
+        return FieldRef{};
+    }
+    std::optional<std::string_view> getField(std::string_view key, std::string_view subkey, std::string_view field) const
+    {
+        return this->resolve(key, subkey, field).get();
+    }
+    template <typename T>
+    std::optional<T> getFieldAs(std::string_view key, std::string_view subkey, std::string_view field) const
+    {
+        return parse<T>(this->getField(key, subkey, field));
+    }
+    // Calls f(key, subkey) once per subsection present in any layer, in unspecified order.
+    template <typename F>
+    void forEachSection(F&& f) const
+    {
+        for (std::size_t i = 0 ; i < this->layers.size() ; i++) {
+            this->layers[i]->forEach([&](std::string_view key, SectionGroup const& group) {
+                group.forEach([&](std::string_view subkey, Section const&) {
+                    bool const seen = std::any_of(this->layers.begin(), this->layers.begin() + i, [&](ConfigTable const* below) {
+                        return (*below)[key].hasSubsection(subkey);
+                    });
+                    if (!seen)
+                        f(key, subkey);
+                });
+            });
+        }
+    }
+    // Calls f(key, subkey, field, value) once per effective field, in unspecified order.
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        this->forEachSection([&](std::string_view key, std::string_view subkey) {
+            this->getSubsection(key, subkey).forEach([&](std::string_view field, std::string_view value) {
+                f(key, subkey, field, value);
+            });
+        });
+    }
+    // One table with the same contents.  Subsections that only one layer has are shared with it rather
+    // than copied (see SectionGroup::mergeShared), so this costs roughly the overridden sections.
+    ConfigTable flatten() const
+    {
+        ConfigTable out;
+        for (auto const* table : this->layers)
+            out.mergeShared(*table);
+        return out;
+    }
+private:
+    // Lowest precedence first.
+    std::vector<ConfigTable const*> layers;
+    std::vector<std::shared_ptr<ConfigTable const>> owned;
+};
+
+struct FieldChange
+{
+    std::string group;
+    std::string subsection;
+    std::string key;
+    // nullopt when the field was added (old_value) or removed (new_value).
+    std::optional<std::string> old_value;
+    std::optional<std::string> new_value;
+};
+
+// Every field that was added, removed or changed between two tables.  Sections shared between the two
+// (e.g. by IncrementalParser, see SectionGroup::shareSubsection) are skipped without comparing their fields.
+inline
+std::vector<FieldChange> diff(ConfigTable const& before, ConfigTable const& after)
+{
+    std::vector<FieldChange> changes;
+    auto const opt = [](std::optional<std::string_view> v) {
+        return v ? std::optional<std::string>{ std::in_place, *v } : std::nullopt;
+    };
+    for (auto const& [group, after_group] : after) {
+        auto const& before_group = before[group];
+        for (auto const& [sub, after_section] : after_group) {
+            auto const& before_section = before_group[sub];
+            if (&before_section == &after_section)
+                continue;
+            for (auto const [key, value] : after_section) {
+                auto const old_value = before_section.getField(key);
+                if (old_value != value)
+                    changes.push_back(FieldChange{ std::string{ group }, std::string{ sub }, std::string{ key }, opt(old_value), std::string{ value } });
+            }
+            for (auto const [key, value] : before_section) {
+                if (!after_section.hasField(key))
+                    changes.push_back(FieldChange{ std::string{ group }, std::string{ sub }, std::string{ key }, std::string{ value }, std::nullopt });
+            }
+        }
+    }
+    for (auto const& [group, before_group] : before) {
+        auto const& after_group = after[group];
+        for (auto const& [sub, before_section] : before_group) {
+            if (after_group.hasSubsection(sub))
+                continue;
+            for (auto const [key, value] : before_section)
+                changes.push_back(FieldChange{ std::string{ group }, std::string{ sub }, std::string{ key }, std::string{ value }, std::nullopt });
+        }
+    }
+    return changes;
+}
+
+// Callbacks keyed by group, subsection and field, fired from a diff of two tables rather than by polling.
+// Subscriptions may name one field, every field of a subsection, or every field of a section group.
+// Thread-safe; callbacks run on the thread calling notify, outside the internal lock.
+class ConfigSubscriptions final
+{
+public:
+    using Callback = std::function<void(FieldChange const&)>;
+    using Id = std::uint64_t;
+
+    Id subscribe(std::string_view group, std::string_view subsection, std::string_view key, Callback cb)
+    {
+        return this->add(pathOf(group, &subsection, &key), std::move(cb));
+    }
+    // Any field of [group subsection].
+    Id subscribeSection(std::string_view group, std::string_view subsection, Callback cb)
+    {
+        return this->add(pathOf(group, &subsection, nullptr), std::move(cb));
+    }
+    // Any field of any subsection of group.
+    Id subscribeGroup(std::string_view group, Callback cb)
+    {
+        return this->add(pathOf(group, nullptr, nullptr), std::move(cb));
+    }
+    void unsubscribe(Id id)
+    {
+        std::lock_guard const lock{ this->mutex };
+        for (auto it = this->subscribers.begin() ; it != this->subscribers.end() ; ++it) {
+            std::erase_if(it->second, [id](auto const& sub) { return sub.first == id; });
+            if (it->second.empty()) {
+                this->subscribers.erase(it);
+                break;
+            }
+        }
+    }
+
+    // Diffs the two tables and fires the callbacks matching each change.
+    void notify(ConfigTable const& before, ConfigTable const& after) const
+    {
+        this->notify(diff(before, after));
+    }
+    void notify(std::vector<FieldChange> const& changes) const
+    {
+        std::vector<std::pair<Callback, FieldChange const*>> calls;
+        {
+            std::lock_guard const lock{ this->mutex };
+            if (this->subscribers.empty())
+                return;
+            for (auto const& change : changes) {
+                std::string_view const sub = change.subsection;
+                std::string_view const key = change.key;
+                for (auto const& path : { pathOf(change.group, &sub, &key), pathOf(change.group, &sub, nullptr), pathOf(change.group, nullptr, nullptr) }) {
+                    auto it = this->subscribers.find(path);
+                    if (it == this->subscribers.end())
+                        continue;
+                    for (auto const& [id, cb] : it->second)
+                        calls.emplace_back(cb, &change);
+                }
+            }
+        }
+        for (auto const& [cb, change] : calls)
+            cb(*change);
+    }
+private:
+    // Levels are separated by '\0', with a trailing marker telling the subscription depth apart.
+    static std::string pathOf(std::string_view group, std::string_view const* subsection, std::string_view const* key)
+    {
+        std::string path{ group };
+        path += '\0';
+        if (subsection != nullptr) {
+            path += *subsection;
+            path += '\0';
+            if (key != nullptr) {
+                path += *key;
+                path += '\0';
+            }
+        }
+        path += static_cast<char>('0' + (subsection != nullptr) + (key != nullptr));
+        return path;
+    }
+    Id add(std::string path, Callback cb)
+    {
+        std::lock_guard const lock{ this->mutex };
+        auto const id = ++this->last_id;
+        this->subscribers[std::move(path)].emplace_back(id, std::move(cb));
+        return id;
+    }
+
+    mutable std::mutex mutex;
+    Id last_id = 0;
+    std::unordered_map<std::string, std::vector<std::pair<Id, Callback>>, StringHash, StringEqual> subscribers;
+};
+
+// Cuts buffer at section header lines and calls on_block(group, subsection, text, first_line) for the
+// leading header-less block (as ("", "")) and then for each header's block, header line included.
+// Only header lines are tokenized; the rest is stepped over by findSectionHeaderLine.
+template <typename F>
+inline
+void forEachSectionBlock(std::string_view buffer, F&& on_block)
+{
+    std::string_view group;
+    std::string_view subsection;
+    std::size_t block_start = 0;
+    uint32_t block_line = 1;
+    uint32_t line_num = 1;
+    for (std::size_t pos = 0 ; ; ) {
+        auto const header = pos + findSectionHeaderLine(buffer.substr(pos));
+        line_num += static_cast<uint32_t>(std::count(buffer.begin() + pos, buffer.begin() + header, '\n'));
+        if (header == buffer.size())
+            break;
+        auto const eol = buffer.find('\n', header);
+        auto line = buffer.substr(header, eol == std::string_view::npos ? std::string_view::npos : eol - header);
+        trimStringViewEnds(line);
+        trimStringComment(line);
+        on_block(group, subsection, buffer.substr(block_start, header - block_start), block_line);
+        std::tie(group, subsection) = parseSectionName(line, line_num);
+        block_start = header;
+        block_line = line_num;
+        if (eol == std::string_view::npos)
+            break;
+        pos = eol + 1;
+        line_num++;
+    }
+    on_block(group, subsection, buffer.substr(block_start), block_line);
+}
+
+struct SectionChange
+{
+    enum class Kind
+    {
+        Added,
+        Removed,
+        Modified,
+    };
+    std::string group;
+    std::string subsection;
+    Kind kind;
+};
+struct IncrementalParseResult
+{
+    std::shared_ptr<ConfigTable const> table;
+    std::vector<SectionChange> changes;
+};
+
+// Re-parses successive versions of a config, rebuilding only the sections whose text changed.  Each
+// (group, subsection) is fingerprinted by hashing the byte ranges of all its header blocks; sections whose
+// fingerprint matches the previous parse are shared with the previous table instead of being re-parsed.
+// Keys and values are always copied (zero_copy and use_arena are ignored), so shared sections never
+// depend on an old buffer or arena.
+class IncrementalParser final
+{
+public:
+    explicit IncrementalParser(ParseOptions options = {}) : options(options)
+    {
+        this->options.zero_copy = false;
+        this->options.use_arena = false;
+        this->options.threads = 1;
+    }
+
+    // On a parse error, throws and leaves the previous state untouched.
+    IncrementalParseResult parse(std::string_view buffer)
+    {
+        auto blocks = splitBlocks(buffer);
+
+        ConfigTable scratch;
+        auto next = std::make_shared<ConfigTable>();
+        std::map<SectionKey, std::size_t> hashes;
+        IncrementalParseResult result;
+        for (auto const& [key, entry] : blocks) {
+            if (!this->options.sections.matches(key.first, key.second))
+                continue;
+            hashes.emplace(key, entry.hash);
+            auto const prev = this->hashes.find(key);
+            std::shared_ptr<Section const> section;
+            if (prev != this->hashes.end() && prev->second == entry.hash) {
+                section = this->previous->getSection(key.first).shareSubsection(key.second);
+            }
+            else {
+                for (auto const& block : entry.blocks)
+                    parseConfigInto(scratch, block.text, block.first_line, this->options);
+                section = scratch.getSection(key.first).shareSubsection(key.second);
+                auto const kind = prev == this->hashes.end() ? SectionChange::Kind::Added : SectionChange::Kind::Modified;
+                result.changes.push_back(SectionChange{ key.first, key.second, kind });
+            }
+            next->getSection(key.first).adoptSubsection(key.second, std::move(section));
+        }
+        for (auto const& [key, hash] : this->hashes) {
+            if (!hashes.contains(key))
+                result.changes.push_back(SectionChange{ key.first, key.second, SectionChange::Kind::Removed });
+        }
+
+        this->previous = next;
+        this->hashes = std::move(hashes);
+        result.table = std::move(next);
+        return result;
+    }
+    IncrementalParseResult parseFile(std::filesystem::path const& filename)
+    {
+        MappedFile const file{ filename };
+        return this->parse(file.view());
+    }
+    // The table from the last successful parse (null before the first).
+    std::shared_ptr<ConfigTable const> current() const
+    {
+        return this->previous;
+    }
+private:
+    using SectionKey = std::pair<std::string, std::string>;
+    struct Block
+    {
+        std::string_view text;
+        uint32_t first_line;
+    };
+    struct Entry
+    {
+        std::size_t hash = 0;
+        std::vector<Block> blocks;
+    };
+
+    static std::map<SectionKey, Entry> splitBlocks(std::string_view buffer)
+    {
+        std::map<SectionKey, Entry> blocks;
+        forEachSectionBlock(buffer, [&](std::string_view group, std::string_view sub, std::string_view text, uint32_t first_line) {
+            auto& entry = blocks[SectionKey{ group, sub }];
+            entry.hash = (entry.hash ^ std::hash<std::string_view>{}(text)) * 1099511628211ull + 1;
+            entry.blocks.push_back(Block{ text, first_line });
+        });
+        return blocks;
+    }
+
+    ParseOptions options;
+    std::shared_ptr<ConfigTable const> previous;
+    std::map<SectionKey, std::size_t> hashes;
+};
+
+// Subsections of one group of a LazyConfigTable; each is parsed on its first access.
+class LazySectionGroup final
+{
+public:
+    bool hasSubsection(std::string_view subkey) const
+    {
+        return this->sections.contains(subkey);
+    }
+    Section const& getSubsection(std::string_view subkey) const
+    {
+        return this->operator[](subkey);
+    }
+    // Parses the subsection if this is its first access.  Safe to call from several threads.
+    Section const& operator[](std::string_view subkey) const
+    {
+        static const Section empty_section;
+        auto it = this->sections.find(subkey);
+        if (it == this->sections.end())
+            return empty_section;
+        return *this->load(it->first, it->second);
+    }
+    // The parsed subsection (null if absent), for adopting it into a ConfigTable.
+    std::shared_ptr<Section const> shareSubsection(std::string_view subkey) const
+    {
+        auto it = this->sections.find(subkey);
+        if (it == this->sections.end())
+            return nullptr;
+        return this->load(it->first, it->second);
+    }
+    // Calls f(subkey) for every subsection, without parsing any of them.
+    template <typename F>
+    void forEachName(F&& f) const
+    {
+        for (auto const& kv : this->sections)
+            f(kv.first);
+    }
+    std::size_t size() const
+    {
+        return this->sections.size();
+    }
+    bool empty() const
+    {
+        return this->sections.empty();
+    }
+private:
+    friend class LazyConfigTable;
+    struct Block
+    {
+        std::string_view text;
+        uint32_t first_line;
+    };
+    struct LazySection
+    {
+        std::vector<Block> blocks;
+        mutable std::once_flag parsed;
+        mutable std::shared_ptr<Section const> section;
+    };
+
+    std::shared_ptr<Section const> const& load(std::string_view subkey, LazySection const& lazy) const
+    {
+        std::call_once(lazy.parsed, [&] {
+            ConfigTable scratch;
+            for (auto const& block : lazy.blocks)
+                parseConfigInto(scratch, block.text, block.first_line, *this->options);
+            lazy.section = scratch.getSection(this->name).shareSubsection(subkey);
+        });
+        return lazy.section;
+    }
+
+    std::string_view name;
+    ParseOptions const* options = nullptr;
+    std::unordered_map<std::string_view, LazySection> sections;
+};
+
+// Read-only table over a config buffer that only indexes section header lines when opened (a scan for
+// '[' at line starts) and tokenizes a section's lines the first time it is looked up.  For large
+// configs of which each process reads a small part.  Parse errors inside a section surface on its
+// first access; header errors surface when the table is opened.
+class LazyConfigTable final
+{
+public:
+    // The caller keeps buffer alive for the lifetime of the table.  options.threads, options.use_arena and
+    // options.diagnostics do not apply; options.sections limits what is indexed.
+    static LazyConfigTable fromBuffer(std::string_view buffer, ParseOptions const& options = {})
+    {
+        LazyConfigTable lazy{ options };
+        lazy.index(buffer);
+        return lazy;
+    }
+    // Maps the file (see MappedFile) and keeps it for the table's lifetime.
+    static LazyConfigTable open(std::filesystem::path const& filename, ParseOptions const& options = {})
+    {
+        LazyConfigTable lazy{ options };
+        lazy.file = std::make_shared<MappedFile const>(filename);
+        lazy.index(lazy.file->view());
+        return lazy;
+    }
+    LazyConfigTable(LazyConfigTable&&) = default;
+    LazyConfigTable& operator=(LazyConfigTable&&) = default;
+
+    bool hasSection(std::string_view key) const
+    {
+        return this->groups.contains(key);
+    }
+    LazySectionGroup const& getSection(std::string_view key) const
+    {
+        return this->operator[](key);
+    }
+    LazySectionGroup const& operator[](std::string_view key) const
+    {
+        static const LazySectionGroup empty_section_group;
+        auto it = this->groups.find(key);
+        if (it == this->groups.end())
+            return empty_section_group;
+        else
+            return it->second;
+    }
+    FieldRef resolve(std::string_view key, std::string_view subkey, std::string_view field) const
+    {
+        return this->operator[](key)[subkey].resolveField(field);
+    }
+    // Calls f(key, group) for every section group, in unspecified order, without parsing any section.
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (auto const& kv : this->groups) {
+            f(kv.first, kv.second);
+        }
+    }
+    std::size_t size() const
+    {
+        return this->groups.size();
+    }
+    bool empty() const
+    {
+        return this->groups.empty();
+    }
+    // Parses every remaining section and returns them as an ordinary table (sections are shared, not copied).
+    ConfigTable materialize() const
+    {
+        ConfigTable ct;
+        for (auto const& [key, group] : this->groups) {
+            auto& out = ct.getSection(key);
+            group.forEachName([&](std::string_view subkey) {
+                out.adoptSubsection(subkey, group.shareSubsection(subkey));
+            });
+        }
+        if (this->file)
+            ct.retainBuffer(this->file);
+        return ct;
+    }
+private:
+    explicit LazyConfigTable(ParseOptions options)
+    {
+        // Sections are parsed on whichever threads first reach them, which cannot share one vector.
+        options.diagnostics = nullptr;
+        this->options = std::make_unique<ParseOptions const>(std::move(options));
+    }
+
+    void index(std::string_view buffer)
+    {
+        forEachSectionBlock(buffer, [&](std::string_view group, std::string_view sub, std::string_view text, uint32_t first_line) {
+            if (!this->options->sections.matches(group, sub))
+                return;
+            auto& lazy_group = this->groups[group];
+            lazy_group.name = group;
+            lazy_group.options = this->options.get();
+            lazy_group.sections[sub].blocks.push_back(LazySectionGroup::Block{ text, first_line });
+        });
+    }
+
+    std::shared_ptr<MappedFile const> file;
+    // Heap-allocated so that the groups' pointers to it survive moving the table.
+    std::unique_ptr<ParseOptions const> options;
+    std::unordered_map<std::string_view, LazySectionGroup> groups;
+};
+
+struct ReloadOptions
+{
+    ParseOptions parse;
+    // Called on the watcher thread after a new table has been published.
+    std::function<void(std::shared_ptr<ConfigTable const> const& old_table, std::shared_ptr<ConfigTable const> const& new_table)> on_reload;
+    // Called on the watcher thread when a re-parse fails; the previous table stays published.
+    std::function<void(std::exception_ptr)> on_error;
+    // How often to check the file's size and mtime where inotify is unavailable.
+    std::chrono::milliseconds poll_interval{ 1000 };
+    // Re-parse through an IncrementalParser, so unchanged sections are shared with the previous table.
+    bool incremental = false;
+    // With incremental: called on the watcher thread, before on_reload, with the sections that changed.
+    std::function<void(std::vector<SectionChange> const& changes)> on_changes;
+};
+
+// Keeps a parsed ConfigTable up to date with a file: watches it (inotify on the containing directory, so
+// editors' write-and-rename is seen too), re-parses on a background thread and publishes the result through
+// an atomic shared_ptr.  Readers take a snapshot with current(); they never block on a parse and never
+// see a partially built table.  With ParseOptions::zero_copy, replace the file by rename rather than
+// rewriting it in place, since published tables keep the old contents mapped.
+class ConfigReloader final
+{
+public:
+    // Parses the file once up front; throws if that fails.  The watch is set up first, so a write that
+    // lands during the initial parse still triggers a reload.
+    explicit ConfigReloader(std::filesystem::path filename, ReloadOptions options = {})
+        : filename(std::move(filename))
+        , options(std::move(options))
+        , incremental(this->options.parse)
+    {
+#if ACFP_HAS_INOTIFY
+        this->inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        this->wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        auto dir = this->filename.parent_path();
+        if (dir.empty())
+            dir = ".";
+        if (this->inotify_fd < 0 || this->wake_fd < 0 || ::inotify_add_watch(this->inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            auto const ec = std::error_code{ errno, std::system_category() };
+            this->closeFds();
+            throw std::filesystem::filesystem_error("Could not watch config file", this->filename, ec);
+        }
+        try {
+            this->table.store(this->parse(), std::memory_order_release);
+        }
+        catch (...) {
+            this->closeFds();
+            throw;
+        }
+#else
+        this->last_stamp = this->stamp();
+        this->table.store(this->parse(), std::memory_order_release);
+#endif
+        this->watcher = std::jthread{ [this](std::stop_token st) { this->watch(st); } };
+    }
+    ~ConfigReloader()
+    {
+        this->watcher.request_stop();
+#if ACFP_HAS_INOTIFY
+        std::uint64_t const one = 1;
+        (void)!::write(this->wake_fd, &one, sizeof(one));
+#else
+        this->wake.notify_all();
+#endif
+        this->watcher.join();
+#if ACFP_HAS_INOTIFY
+        this->closeFds();
+#endif
+    }
+    ConfigReloader(ConfigReloader const&) = delete;
+    ConfigReloader& operator=(ConfigReloader const&) = delete;
+
+    // The most recently published table.
+    std::shared_ptr<ConfigTable const> current() const
+    {
+        return this->table.load(std::memory_order_acquire);
+    }
+    // Re-parses and publishes now, on the calling thread; returns false (after on_error) if parsing failed.
+    bool reload()
+    {
+        std::lock_guard const lock{ this->reload_mutex };
+        std::shared_ptr<ConfigTable const> next;
+        try {
+            next = this->parse();
+        }
+        catch (...) {
+            if (this->options.on_error)
+                this->options.on_error(std::current_exception());
+            return false;
+        }
+        auto prev = this->table.exchange(next, std::memory_order_acq_rel);
+        if (this->options.on_reload)
+            this->options.on_reload(prev, next);
+        return true;
+    }
+private:
+    std::shared_ptr<ConfigTable const> parse()
+    {
+        if (!this->options.incremental)
+            return std::make_shared<ConfigTable const>(parseConfigFile(this->filename, this->options.parse));
+        auto result = this->incremental.parseFile(this->filename);
+        if (this->options.on_changes)
+            this->options.on_changes(result.changes);
+        return std::move(result.table);
+    }
+#if ACFP_HAS_INOTIFY
+    void watch(std::stop_token st)
+    {
+        auto const name = this->filename.filename().native();
+        alignas(inotify_event) char events[4096];
+        pollfd fds[2] = { { this->inotify_fd, POLLIN, 0 }, { this->wake_fd, POLLIN, 0 } };
+        while (!st.stop_requested()) {
+            if (::poll(fds, 2, -1) < 0 && errno != EINTR) {
+                if (this->options.on_error) {
+                    auto const ec = std::error_code{ errno, std::system_category() };
+                    this->options.on_error(std::make_exception_ptr(std::filesystem::filesystem_error("Stopped watching config file", this->filename, ec)));
+                }
+                break;
+            }
+            bool changed = false;
+            for (;;) {
+                auto const n = ::read(this->inotify_fd, events, sizeof(events));
+                if (n <= 0)
+                    break;
+                for (char const* p = events ; p < events + n ; ) {
+                    auto const* ev = reinterpret_cast<inotify_event const*>(p);
+                    if (ev->len != 0 && name == ev->name)
+                        changed = true;
+                    p += sizeof(inotify_event) + ev->len;
+                }
+            }
+            if (changed && !st.stop_requested())
+                this->reload();
+        }
+    }
+    void closeFds()
+    {
+        if (this->inotify_fd >= 0)
+            ::close(this->inotify_fd);
+        if (this->wake_fd >= 0)
+            ::close(this->wake_fd);
+    }
+#else
+    using Stamp = std::pair<std::filesystem::file_time_type, std::uintmax_t>;
+    Stamp stamp() const
+    {
+        std::error_code ec;
+        return Stamp{ std::filesystem::last_write_time(this->filename, ec), std::filesystem::file_size(this->filename, ec) };
+    }
+    void watch(std::stop_token st)
+    {
+        std::unique_lock lock{ this->wake_mutex };
+        while (!this->wake.wait_for(lock, st, this->options.poll_interval, [] { return false; })) {
+            if (st.stop_requested())
+                break;
+            auto const now = this->stamp();
+            if (now != this->last_stamp) {
+                this->last_stamp = now;
+                this->reload();
+            }
+        }
+    }
+#endif
+
+    std::filesystem::path filename;
+    ReloadOptions options;
+    IncrementalParser incremental;
+    std::atomic<std::shared_ptr<ConfigTable const>> table;
+    std::mutex reload_mutex;
+#if ACFP_HAS_INOTIFY
+    int inotify_fd = -1;
+    int wake_fd = -1;
+#else
+    Stamp last_stamp;
+    std::mutex wake_mutex;
+    std::condition_variable_any wake;
+#endif
+    // Last, so the thread is started after (and stopped before) everything it uses.
+    std::jthread watcher;
+};
+
 }
@@ -0,0 +1,202 @@
+// Copyright (c) 2024 Matt M Halenza
+// SPDX-License-Identifier: MIT
+//
+// Standalone benchmark suite for the parser and the accessors.  Inputs come from a seeded synthetic
+// config generator, so runs are reproducible offline and comparable across commits.
+//
+//   c++ -std=c++20 -O2 -I.. ACFP_bench.cpp -o ACFP_bench
+//   ./ACFP_bench [name-filter] > bench_output.txt
+#include "ACFP.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+namespace {
+
+struct SyntheticConfig
+{
+    std::size_t groups = 10;
+    std::size_t subsections_per_group = 4;
+    std::size_t fields_per_section = 25;
+    // Fraction of keys/values written as quoted strings, and of lines carrying a trailing comment.
+    double quoted = 0.0;
+    double commented = 0.0;
+    std::uint32_t seed = 1;
+};
+
+std::string groupName(std::size_t g) { return std::format("group_{}", g); }
+std::string subsectionName(std::size_t s) { return std::format("sub_{}", s); }
+std::string fieldName(std::size_t f) { return std::format("field_{}", f); }
+
+std::string generate(SyntheticConfig const& cfg)
+{
+    std::mt19937 rng{ cfg.seed };
+    std::bernoulli_distribution quote{ cfg.quoted };
+    std::bernoulli_distribution comment{ cfg.commented };
+    std::string out;
+    for (std::size_t g = 0 ; g < cfg.groups ; g++) {
+        for (std::size_t s = 0 ; s < cfg.subsections_per_group ; s++) {
+            out += std::format("[{} {}]\n", groupName(g), subsectionName(s));
+            if (comment(rng))
+                out += "# generated section\n";
+            for (std::size_t f = 0 ; f < cfg.fields_per_section ; f++) {
+                if (quote(rng))
+                    out += std::format("  \"{}\" = \"value with spaces = {}\"", fieldName(f), rng() % 100000);
+                else
+                    out += std::format("  {} = {}", fieldName(f), rng() % 100000);
+                if (comment(rng))
+                    out += "  // trailing comment";
+                out += '\n';
+            }
+        }
+    }
+    return out;
+}
+
+// Runs fn enough times to fill ~200ms and reports the per-call cost (and MB/s when bytes is set).
+template <typename F>
+void run(std::string_view filter, std::string const& name, std::size_t bytes, F&& fn)
+{
+    if (name.find(filter) == std::string::npos)
+        return;
+    using clock = std::chrono::steady_clock;
+    std::size_t iterations = 1;
+    double seconds = 0;
+    for (;;) {
+        auto const t0 = clock::now();
+        for (std::size_t i = 0 ; i < iterations ; i++)
+            fn();
+        seconds = std::chrono::duration<double>(clock::now() - t0).count();
+        if (seconds > 0.2 || iterations > (std::size_t{ 1 } << 30))
+            break;
+        iterations *= seconds < 0.02 ? 10 : 2;
+    }
+    auto const ns = seconds * 1e9 / double(iterations);
+    if (bytes != 0)
+        std::printf("%-48s %14.1f ns/op %10.1f MB/s\n", name.c_str(), ns, double(bytes) / (1024.0 * 1024.0) / (ns / 1e9));
+    else
+        std::printf("%-48s %14.1f ns/op\n", name.c_str(), ns);
+    std::fflush(stdout);
+}
+
+template <typename T>
+void doNotOptimize(T const& v)
+{
+    asm volatile("" : : "g"(&v) : "memory");
+}
+
+void benchParse(std::string_view filter)
+{
+    struct Case { char const* name; SyntheticConfig cfg; };
+    Case const cases[] = {
+        { "small", { .groups = 2, .subsections_per_group = 2, .fields_per_section = 10 } },
+        { "medium", { .groups = 20, .subsections_per_group = 10, .fields_per_section = 50 } },
+        { "huge", { .groups = 200, .subsections_per_group = 50, .fields_per_section = 100 } },
+        { "quoted+commented", { .groups = 20, .subsections_per_group = 10, .fields_per_section = 50, .quoted = 0.8, .commented = 0.5 } },
+    };
+    for (auto const& c : cases) {
+        auto const text = generate(c.cfg);
+        run(filter, std::format("parse/{}/istream", c.name), text.size(), [&] {
+            std::istringstream is{ text };
+            doNotOptimize(ACFP::parseConfigFile(is));
+        });
+        run(filter, std::format("parse/{}/line-by-line", c.name), text.size(), [&] {
+            doNotOptimize(ACFP::parseConfigBuffer(text, { .vectorized_scan = false }));
+        });
+        run(filter, std::format("parse/{}/buffer", c.name), text.size(), [&] {
+            doNotOptimize(ACFP::parseConfigBuffer(text));
+        });
+        run(filter, std::format("parse/{}/zero-copy", c.name), text.size(), [&] {
+            doNotOptimize(ACFP::parseConfigBuffer(text, { .zero_copy = true }));
+        });
+        run(filter, std::format("parse/{}/arena", c.name), text.size(), [&] {
+            doNotOptimize(ACFP::parseConfigBuffer(text, { .use_arena = true }));
+        });
+        run(filter, std::format("parse/{}/threads=0", c.name), text.size(), [&] {
+            doNotOptimize(ACFP::parseConfigBuffer(text, { .threads = 0 }));
+        });
+        ACFP::ParseOptions selective;
+        selective.sections.section(groupName(0), subsectionName(0));
+        run(filter, std::format("parse/{}/one-section", c.name), text.size(), [&] {
+            doNotOptimize(ACFP::parseConfigBuffer(text, selective));
+        });
+        run(filter, std::format("parse/{}/lazy-one-section", c.name), text.size(), [&] {
+            auto const lazy = ACFP::LazyConfigTable::fromBuffer(text);
+            doNotOptimize(lazy[groupName(0)][subsectionName(0)].size());
+        });
+    }
+}
+
+void benchLookup(std::string_view filter)
+{
+    for (std::size_t fields : { 16, 1024, 65536 }) {
+        SyntheticConfig const cfg{ .groups = 4, .subsections_per_group = 4, .fields_per_section = fields / 16 };
+        auto const table = ACFP::parseConfigBuffer(generate(cfg));
+        auto const frozen = ACFP::freeze(table);
+
+        // A fixed pseudo-random access pattern, mostly hits with a few misses.
+        std::mt19937 rng{ 7 };
+        std::vector<std::array<std::string, 3>> keys(4096);
+        for (auto& k : keys) {
+            k = { groupName(rng() % cfg.groups), subsectionName(rng() % cfg.subsections_per_group), fieldName(rng() % (cfg.fields_per_section + 1)) };
+        }
+        std::vector<ACFP::FieldRef> refs;
+        for (auto const& k : keys)
+            refs.push_back(table.resolve(k[0], k[1], k[2]));
+
+        std::size_t i = 0;
+        auto const next = [&]() -> auto const& { return keys[i++ & (keys.size() - 1)]; };
+        run(filter, std::format("lookup/{}/getField", fields), 0, [&] {
+            auto const& k = next();
+            doNotOptimize(table[k[0]][k[1]].getField(k[2]));
+        });
+        run(filter, std::format("lookup/{}/getFieldAs<int>", fields), 0, [&] {
+            auto const& k = next();
+            doNotOptimize(table[k[0]][k[1]].getFieldAs<int>(k[2]));
+        });
+        run(filter, std::format("lookup/{}/getFieldAsCached<int>", fields), 0, [&] {
+            auto const& k = next();
+            doNotOptimize(table[k[0]][k[1]].getFieldAsCached<int>(k[2]));
+        });
+#if ACFP_HAS_EXPECTED
+        run(filter, std::format("lookup/{}/getFieldOr<int>", fields), 0, [&] {
+            auto const& k = next();
+            doNotOptimize(table[k[0]][k[1]].getFieldOr<int>(k[2], -1));
+        });
+#endif
+        run(filter, std::format("lookup/{}/FieldRef::getAs<int>", fields), 0, [&] {
+            doNotOptimize(refs[i++ & (refs.size() - 1)].getAs<int>());
+        });
+        run(filter, std::format("lookup/{}/frozen getField", fields), 0, [&] {
+            auto const& k = next();
+            doNotOptimize(frozen[k[0]][k[1]].getField(k[2]));
+        });
+    }
+}
+
+void benchIterate(std::string_view filter)
+{
+    for (std::size_t fields : { 16, 1024, 65536 }) {
+        auto const table = ACFP::parseConfigBuffer(generate({ .groups = 1, .subsections_per_group = 1, .fields_per_section = fields }));
+        auto const& section = table[groupName(0)][subsectionName(0)];
+        run(filter, std::format("iterate/{}/Section::iterate", fields), 0, [&] {
+            std::size_t total = 0;
+            section.iterate([&](std::string_view k, std::string_view v) { total += k.size() + v.size(); });
+            doNotOptimize(total);
+        });
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string_view const filter = argc > 1 ? argv[1] : "";
+    benchParse(filter);
+    benchLookup(filter);
+    benchIterate(filter);
+    return 0;
+}
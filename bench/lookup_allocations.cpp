@@ -0,0 +1,117 @@
+// Copyright (c) 2024 Matt M Halenza
+// SPDX-License-Identifier: MIT
+//
+// Counts heap allocations per lookup through the ConfigTable accessors, next to the
+// pre-transparent-lookup pattern of building a std::string key for every probe.
+//
+//   c++ -std=c++20 -O2 -I.. lookup_allocations.cpp -o lookup_allocations && ./lookup_allocations
+#include "ACFP.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::size_t> g_allocations{ 0 };
+
+// The replacements below pair malloc with free, which is correct for a replaced global operator new, but
+// GCC's -Wmismatched-new-delete flags the free once a delete is inlined next to a new-expression.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+// std::pmr's default resource allocates through the aligned overloads.
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    auto const a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a))
+        return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// Long enough that std::string cannot keep them in its small-string buffer.
+constexpr std::string_view group_name = "service_frontend_configuration";
+constexpr std::string_view subsection_name = "primary_listener_endpoint";
+constexpr std::string_view field_name = "request_timeout_milliseconds";
+
+template <typename F>
+void report(char const* name, std::size_t iterations, F&& f)
+{
+    std::size_t sink = 0;
+    auto const allocs_before = g_allocations.load();
+    auto const t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0 ; i < iterations ; i++)
+        sink += f();
+    auto const t1 = std::chrono::steady_clock::now();
+    auto const allocs = g_allocations.load() - allocs_before;
+    auto const ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::printf("%-40s %8.3f allocs/lookup %8.1f ns/lookup (sink %zu)\n",
+                name, double(allocs) / double(iterations), ns / double(iterations), sink);
+}
+
+}
+
+int main()
+{
+    constexpr std::size_t iterations = 1'000'000;
+
+    ACFP::ConfigTable ct;
+    ct.getSection(group_name).getSubsection(subsection_name).setField(field_name, "250");
+    for (int i = 0 ; i < 64 ; i++)
+        ct.getSection(group_name).getSubsection(subsection_name).setField(std::format("padding_field_number_{:04}", i), "x");
+
+    // What every accessor did before: a std::string key per map probe.
+    std::unordered_map<std::string, std::unordered_map<std::string, std::unordered_map<std::string, std::string>>> legacy;
+    legacy[std::string{ group_name }][std::string{ subsection_name }][std::string{ field_name }] = "250";
+
+    report("legacy std::string{ key } probes", iterations, [&] {
+        auto const& g = legacy.find(std::string{ group_name })->second;
+        auto const& s = g.find(std::string{ subsection_name })->second;
+        return s.find(std::string{ field_name })->second.size();
+    });
+    report("ConfigTable[g][s].getField(k)", iterations, [&] {
+        return ct[group_name][subsection_name].getField(field_name)->size();
+    });
+    report("ConfigTable[g][s].getFieldAs<int>(k)", iterations, [&] {
+        return std::size_t(*ct[group_name][subsection_name].getFieldAs<int>(field_name));
+    });
+    report("hasSection/hasSubsection/hasField", iterations, [&] {
+        return std::size_t(ct.hasSection(group_name) + ct[group_name].hasSubsection(subsection_name)
+                           + ct[group_name][subsection_name].hasField(field_name));
+    });
+    report("char const* keys", iterations, [&] {
+        return ct["service_frontend_configuration"]["primary_listener_endpoint"].getField("request_timeout_milliseconds")->size();
+    });
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2024 Matt M Halenza
+// SPDX-License-Identifier: MIT
+//
+// Parse throughput of parseConfigBuffer over large synthetic configs, line-by-line scalar path
+// versus the vectorized line scanner (per instruction set).
+//
+//   c++ -std=c++20 -O2 -I.. scan_throughput.cpp -o scan_throughput && ./scan_throughput
+#include "ACFP.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+std::string makeConfig(std::size_t target_bytes, bool quoted, bool commented)
+{
+    std::mt19937 rng{ 42 };
+    std::string out;
+    out.reserve(target_bytes + 256);
+    for (std::size_t section = 0 ; out.size() < target_bytes ; section++) {
+        out += std::format("[group_{} sub_{}]\n", section % 97, section);
+        for (int field = 0 ; field < 32 ; field++) {
+            if (quoted)
+                out += std::format("    \"key_{}\" = \"value {} with = and spaces inside\"", field, rng());
+            else
+                out += std::format("    key_{} = {}", field, rng());
+            if (commented)
+                out += "    # trailing comment";
+            out += '\n';
+        }
+        if (commented)
+            out += "// section separator\n\n";
+    }
+    return out;
+}
+
+double measureMBps(std::string const& config, ACFP::ParseOptions const& options, std::function<void()> const& parse_fn = {})
+{
+    constexpr int reps = 5;
+    double best = 0;
+    for (int r = 0 ; r < reps ; r++) {
+        auto const t0 = std::chrono::steady_clock::now();
+        if (parse_fn)
+            parse_fn();
+        else
+            (void)ACFP::parseConfigBuffer(config, options);
+        auto const t1 = std::chrono::steady_clock::now();
+        auto const mbps = double(config.size()) / (1024.0 * 1024.0) / std::chrono::duration<double>(t1 - t0).count();
+        best = std::max(best, mbps);
+    }
+    return best;
+}
+
+double measureScanMBps(std::string const& config, ACFP::ScanIsa isa)
+{
+    // Scanner alone, without building a table.
+    return measureMBps(config, {}, [&] {
+        std::size_t lines = 0;
+        ACFP::scanLines(config, [&](ACFP::ScannedLine const&) { lines++; }, isa);
+        if (lines == 0)
+            std::puts("");
+    });
+}
+
+}
+
+int main()
+{
+    struct Case { char const* name; bool quoted; bool commented; };
+    for (auto const& c : { Case{ "plain", false, false }, Case{ "commented", false, true }, Case{ "quoted", true, true } }) {
+        auto const config = makeConfig(64 * 1024 * 1024, c.quoted, c.commented);
+        std::printf("%s (%.1f MiB)\n", c.name, double(config.size()) / (1024.0 * 1024.0));
+        std::printf("  parse, line by line (scalar) %9.1f MB/s\n", measureMBps(config, { .vectorized_scan = false }));
+        std::printf("  parse, vectorized scan       %9.1f MB/s\n", measureMBps(config, {}));
+        std::printf("  parse, vectorized zero-copy  %9.1f MB/s\n", measureMBps(config, { .zero_copy = true }));
+        std::printf("  scan only, scalar            %9.1f MB/s\n", measureScanMBps(config, ACFP::ScanIsa::Scalar));
+#if ACFP_HAS_X86_SIMD
+        std::printf("  scan only, SSE2              %9.1f MB/s\n", measureScanMBps(config, ACFP::ScanIsa::SSE2));
+        if (ACFP::detectScanIsa() == ACFP::ScanIsa::AVX2)
+            std::printf("  scan only, AVX2              %9.1f MB/s\n", measureScanMBps(config, ACFP::ScanIsa::AVX2));
+#endif
+    }
+    return 0;
+}